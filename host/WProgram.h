@@ -0,0 +1,61 @@
+/*
+ * WProgram.h
+ *
+ * Stands in for the Teensy core's WProgram.h in the host build, so that
+ * main.cpp and unit_tests.cpp compile unchanged. Serial is the process's
+ * stdout.
+ */
+
+#ifndef HOST_WPROGRAM_H_
+#define HOST_WPROGRAM_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <type_traits>
+
+#define DEC 10
+#define HEX 16
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+
+class HostSerial {
+ public:
+  size_t print(const char *s) { return fputs(s, stdout) < 0 ? 0 : strlen(s); }
+  size_t print(char c) { return putchar(c) == EOF ? 0 : 1; }
+
+  template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+  size_t print(T n, int base = DEC) {
+    char buf[8 * sizeof(T) + 2];
+    char *ptr = buf + sizeof(buf);
+    bool negative = std::is_signed<T>::value && n < 0 && base == DEC;
+    // Like the Teensy core, only decimal numbers print with a sign.
+    uint64_t x = negative ? -(int64_t)n : (uint64_t)(typename std::make_unsigned<T>::type)n;
+    *--ptr = 0;
+    do {
+      uint32_t digit = x % base;
+      *--ptr = digit < 10 ? '0' + digit : 'A' + digit - 10;
+      x /= base;
+    } while (x != 0);
+    if (negative) *--ptr = '-';
+    return print(ptr);
+  }
+
+  size_t println() { return print('\n'); }
+  size_t println(const char *s) { return print(s) + println(); }
+  size_t println(char c) { return print(c) + println(); }
+
+  template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+  size_t println(T n, int base = DEC) { return print(n, base) + println(); }
+};
+
+inline HostSerial Serial;
+
+inline void delay(uint32_t) {}
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWriteFast(uint8_t, uint8_t) {}
+
+#endif /* HOST_WPROGRAM_H_ */
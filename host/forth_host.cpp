@@ -0,0 +1,3098 @@
+/*
+ * forth_host.cpp
+ *
+ * The PixieForth engine for Linux hosts, so that we can run the unit tests
+ * and benchmarks without a board. It implements the same words as
+ * forth_system.S, and keeps everything C can see the same:
+ *   - the dictionary header layout, with the same forth_name_<label> and
+ *     forth_<label> symbols,
+ *   - the forth_var_<name> variables,
+ *   - forth_enter(param_stack, word), and
+ *   - STDIN/STDIN_COUNT for feeding it from memory.
+ *
+ * Forth addresses are 32 bits, so this has to be linked as a non-PIE
+ * executable, where all the static data and code live in the low 4GB.
+ *
+ * The dictionary is laid out by the assembler, just like on the board, so
+ * that it is all there before any C++ static initializers run. The only
+ * difference is that a code field points at a forth_code_<label> slot
+ * holding the address of the word's code in forth_enter. The code is
+ * dispatched with computed gotos.
+ *
+ * The host compiles indirect and token threaded code. NATIVE is accepted,
+ * but definitions are still indirect threaded. There is no direct
+ * threaded build: code fields here are always addresses.
+ *
+ * SIGUSR1 stands in for the NVIC: forth_host_raise_irq() pends an IRQ and
+ * signals the main thread, whose handler runs the word bound to it on the
+ * interrupt stacks, as forth_irq_entry does on the board.
+ */
+
+#include <atomic>
+#include <forth_system.h>
+#include <kinetis.h>
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <usb_serial.h>
+
+#ifdef FORTH_DIRECT_THREADED
+#error "The host engine is indirect threaded only."
+#endif
+
+/* Tail calls and inlining start off when profiling, as in forth_system.S. */
+#if defined(FORTH_PROFILE) || defined(FORTH_NO_TAIL_CALLS)
+#define FORTH_TAIL_CALLS 0
+#else
+#define FORTH_TAIL_CALLS 1
+#endif
+#ifdef FORTH_PROFILE
+#define FORTH_INLINE_SIZE 0
+#else
+#define FORTH_INLINE_SIZE 3
+#endif
+
+/*
+ * The builtin dictionary, in the same order as forth_system.S.
+ *   NATIVE(name, flags, label) is a word implemented in forth_enter.
+ *   VAR(name, label, initial) is a VALUE that keeps its value in forth_var_<name>.
+ *   WORD(name, flags, label, body) is a word defined as a list of words.
+ */
+#define FORTH_HOST_DICTIONARY(NATIVE, VAR, WORD) \
+  VAR(BASE, base, 10) \
+  VAR(HERE, here, _sheap) \
+  VAR(STATE, state, 0) \
+  VAR(STDIN, stdin, 0) \
+  VAR(STDIN_COUNT, stdin_count, 0) \
+  VAR(THREADING, threading, 0) \
+  VAR(FLUSH_POLICY, flush_policy, 0) \
+  VAR(TAIL_CALLS, tail_calls, FORTH_TAIL_CALLS) \
+  VAR(INLINE_SIZE, inline_size, FORTH_INLINE_SIZE) \
+  NATIVE("QUIT", 0, quit) \
+  NATIVE("EXIT", 0, exit) \
+  NATIVE("LIT", 0, lit) \
+  NATIVE("DROP", 0, drop) \
+  NATIVE("2DROP", 0, 2drop) \
+  NATIVE("SWAP", 0, swap) \
+  NATIVE("2SWAP", 0, 2swap) \
+  NATIVE("DUP", 0, dup) \
+  NATIVE("2DUP", 0, 2dup) \
+  NATIVE("?DUP", 0, maybe_dup) \
+  NATIVE("OVER", 0, over) \
+  NATIVE("ROT", 0, rot) \
+  NATIVE("-ROT", 0, nrot) \
+  NATIVE("1+", 0, inc) \
+  NATIVE("1-", 0, dec) \
+  NATIVE("4+", 0, inc4) \
+  NATIVE("4-", 0, dec4) \
+  NATIVE("+", 0, add) \
+  NATIVE("-", 0, sub) \
+  NATIVE("*", 0, mul) \
+  NATIVE("/MOD", 0, divmod) \
+  NATIVE("/", 0, div) \
+  NATIVE("UM*", 0, umul) \
+  NATIVE("M*", 0, mmul) \
+  NATIVE("UM/MOD", 0, um_divmod) \
+  NATIVE("SM/REM", 0, sm_divrem) \
+  NATIVE("FM/MOD", 0, fm_divmod) \
+  NATIVE("*/", 0, star_slash) \
+  NATIVE("*/MOD", 0, star_slash_mod) \
+  NATIVE("D+", 0, dadd) \
+  NATIVE("D-", 0, dsub) \
+  NATIVE("DNEGATE", 0, dnegate) \
+  NATIVE("D<", 0, dlt) \
+  NATIVE("=", 0, eq) \
+  NATIVE("<>", 0, ne) \
+  NATIVE("<", 0, lt) \
+  NATIVE(">", 0, gt) \
+  NATIVE("<=", 0, le) \
+  NATIVE(">=", 0, ge) \
+  NATIVE("0=", 0, eqz) \
+  NATIVE("0<>", 0, nez) \
+  NATIVE("0<", 0, ltz) \
+  NATIVE("0>", 0, gtz) \
+  NATIVE("0<=", 0, lez) \
+  NATIVE("0>=", 0, gez) \
+  NATIVE("AND", 0, and) \
+  NATIVE("OR", 0, or) \
+  NATIVE("XOR", 0, xor) \
+  NATIVE("INVERT", 0, not) \
+  NATIVE("LSHIFT", 0, lshift) \
+  NATIVE("RSHIFT", 0, rshift) \
+  NATIVE("!", 0, store) \
+  NATIVE("C!", 0, store_char) \
+  NATIVE("@", 0, fetch) \
+  NATIVE("C@", 0, fetch_char) \
+  NATIVE("+!", 0, addstore) \
+  NATIVE("-!", 0, substore) \
+  NATIVE("MEMCOPY", 0, memcpy) \
+  NATIVE("MEMMOVE", 0, memmove) \
+  NATIVE(">R", 0, param_to_return) \
+  NATIVE("R>", 0, return_to_param) \
+  NATIVE("R@", 0, fetch_return) \
+  NATIVE("R!", 0, store_return) \
+  NATIVE("SOURCE", 0, source) \
+  NATIVE(">IN", 0, to_in) \
+  NATIVE("REFILL", 0, refill) \
+  NATIVE("KEY", 0, key) \
+  NATIVE("ACCEPT", 0, accept) \
+  NATIVE("EMIT", 0, emit) \
+  NATIVE("TYPE", 0, type) \
+  NATIVE("FLUSH", 0, flush) \
+  NATIVE("FLUSH-ON-NEWLINE", 0, flush_on_newline) \
+  NATIVE("FLUSH-ON-IDLE", 0, flush_on_idle) \
+  NATIVE("FLUSH-WHEN-FULL", 0, flush_when_full) \
+  NATIVE("WORD", 0, word) \
+  NATIVE("PARSE-NAME", 0, parse_name) \
+  NATIVE("NUMBER", 0, number) \
+  NATIVE("FIND", 0, find) \
+  NATIVE(">CFA", 0, to_code_field_addr) \
+  NATIVE(">DFA", 0, to_data_field_addr) \
+  NATIVE("(CREATE)", 0, create) \
+  NATIVE(",", 0, store_to_here) \
+  NATIVE("LIT+", 0, lit_add) \
+  NATIVE("DUP0BRANCH", 0, dup_brancheq) \
+  NATIVE("NIP", 0, nip) \
+  NATIVE("@+", 0, fetch_add) \
+  NATIVE("[", F_IMMED, immediate_mode) \
+  NATIVE("]", 0, compile_mode) \
+  NATIVE("HIDDEN", 0, toggle_hidden) \
+  NATIVE("IMMEDIATE", 0, toggle_immediate) \
+  NATIVE("INLINE", 0, toggle_inline) \
+  NATIVE("BRANCH", 0, branch) \
+  NATIVE("0BRANCH", 0, brancheq) \
+  NATIVE(">MARK", 0, mark_forward) \
+  NATIVE(">RESOLVE", 0, resolve_forward) \
+  NATIVE("<RESOLVE", 0, resolve_backward) \
+  NATIVE("(DO)", 0, paren_do) \
+  NATIVE("(?DO)", 0, paren_maybe_do) \
+  NATIVE("(LOOP)", 0, paren_loop) \
+  NATIVE("(+LOOP)", 0, paren_plus_loop) \
+  NATIVE("I", 0, i) \
+  NATIVE("J", 0, j) \
+  NATIVE("LEAVE", 0, leave) \
+  NATIVE("UNLOOP", 0, unloop) \
+  NATIVE("DO", F_IMMED, do) \
+  NATIVE("?DO", F_IMMED, maybe_do) \
+  NATIVE("LOOP", F_IMMED, loop) \
+  NATIVE("+LOOP", F_IMMED, plus_loop) \
+  NATIVE("CHAR", 0, char) \
+  NATIVE("'\\\\n'", 0, char_newline) \
+  NATIVE("NL", 0, emit_newline) \
+  NATIVE("CR", 0, cr) \
+  NATIVE("BL", 0, char_space) \
+  NATIVE("SPACE", 0, emit_space) \
+  NATIVE("THREADED", 0, threaded_mode) \
+  NATIVE("NATIVE", 0, native_mode) \
+  NATIVE("TOKENS", 0, token_mode) \
+  NATIVE("PROLOGUE,", 0, prologue) \
+  NATIVE("EPILOGUE,", 0, epilogue) \
+  NATIVE("(TAIL)", 0, paren_tail) \
+  NATIVE("TAIL-CALLS-ON", 0, tail_calls_on) \
+  NATIVE("TAIL-CALLS-OFF", 0, tail_calls_off) \
+  NATIVE("TAIL-CALL,", 0, tail_call_comma) \
+  NATIVE("COMPILE,", 0, compile_comma) \
+  WORD(":", 0, compile_def, \
+      "forth_parse_name, forth_create, forth_prologue, forth_latest, forth_toggle_hidden, forth_compile_mode") \
+  WORD(";", F_IMMED, end_compile_def, \
+      "forth_epilogue, forth_latest, forth_toggle_hidden, forth_immediate_mode") \
+  WORD("HIDE", 0, hide, \
+      "forth_parse_name, forth_find, forth_toggle_hidden") \
+  WORD("'", 0, code_field_addr_of_next_word, \
+      "forth_parse_name, forth_find, forth_to_code_field_addr") \
+  NATIVE("CREATE", 0, create_named) \
+  NATIVE("VARIABLE", 0, variable) \
+  NATIVE("CONSTANT", 0, constant) \
+  NATIVE("VALUE", 0, value) \
+  NATIVE("TO", F_IMMED, to) \
+  NATIVE("(DOES>)", 0, paren_does) \
+  NATIVE("DOES>", F_IMMED, does) \
+  NATIVE("LITERAL", F_IMMED, literal) \
+  NATIVE("INTERPRET", 0, interpret) \
+  NATIVE("PAUSE", 0, pause) \
+  NATIVE("TASK", 0, task) \
+  NATIVE("START", 0, start) \
+  NATIVE("STOP", 0, stop) \
+  VAR(IRQ_LATENCY, irq_latency, 0) \
+  NATIVE("BIND-IRQ", 0, bind_irq) \
+  NATIVE("TRIGGER-IRQ", 0, trigger_irq) \
+  NATIVE("F+", 0, fadd) \
+  NATIVE("F-", 0, fsub) \
+  NATIVE("F*", 0, fmul) \
+  NATIVE("F/", 0, fdiv) \
+  NATIVE("FSQRT", 0, fsqrt) \
+  NATIVE("FNEGATE", 0, fnegate) \
+  NATIVE("FABS", 0, fabs) \
+  NATIVE("FDUP", 0, fdup) \
+  NATIVE("FDROP", 0, fdrop) \
+  NATIVE("FSWAP", 0, fswap) \
+  NATIVE("FOVER", 0, fover) \
+  NATIVE("F@", 0, ffetch) \
+  NATIVE("F!", 0, fstore) \
+  NATIVE("F>S", 0, f_to_s) \
+  NATIVE("S>F", 0, s_to_f) \
+  NATIVE("F<", 0, flt) \
+  NATIVE("F0<", 0, fltz) \
+  NATIVE("F0=", 0, feqz) \
+  NATIVE("(FLITERAL)", 0, paren_fliteral) \
+  NATIVE("FLITERAL", F_IMMED, fliteral) \
+  NATIVE("V+", 0, vadd) \
+  NATIVE("V-", 0, vsub) \
+  NATIVE("V*", 0, vmul) \
+  NATIVE("VH+", 0, vhadd) \
+  NATIVE("VH-", 0, vhsub) \
+  NATIVE("VH*", 0, vhmul) \
+  NATIVE("VH+SAT", 0, vhadd_sat) \
+  NATIVE("VC+", 0, vcadd) \
+  NATIVE("VC-", 0, vcsub) \
+  NATIVE("VC*", 0, vcmul) \
+  NATIVE("VC+SAT", 0, vcadd_sat) \
+  NATIVE("VHDOT", 0, vhdot) \
+  NATIVE("VHMAC", 0, vhmac) \
+  NATIVE("VCSAD", 0, vcsad) \
+  NATIVE("VSUM", 0, vsum) \
+  NATIVE("VMIN", 0, vmin) \
+  NATIVE("VMAX", 0, vmax) \
+  NATIVE("VHSUM", 0, vhsum) \
+  NATIVE("VHMIN", 0, vhmin) \
+  NATIVE("VHMAX", 0, vhmax) \
+  FORTH_HOST_PROFILE_WORDS(NATIVE) \
+  VAR(LATEST, latest, forth_name_latest)
+
+#ifdef FORTH_PROFILE
+#define FORTH_HOST_PROFILE_WORDS(NATIVE) \
+  NATIVE("PROFILE-RESET", 0, profile_reset) \
+  NATIVE("PROFILE-SORT", 0, profile_sort) \
+  NATIVE("PROFILE-DUMP", 0, profile_dump)
+#else
+#define FORTH_HOST_PROFILE_WORDS(NATIVE)
+#endif
+
+#define FIND_INDEX_BUCKETS 256
+#define FIND_INDEX_NODES 1024
+#define HEAP_SIZE (4 << 20)
+#define OUTPUT_BUFFER_SIZE 256
+#define TIB_SIZE 256
+#define TOKEN_TABLE_SIZE 512
+#define TOKEN_SPECIALS 11
+#define RETURN_STACK_SIZE (64 << 10)
+#define PROFILE_RECORDS 256
+#define PROFILE_BUCKET_BITS 9
+#define PROFILE_BUCKETS (1 << PROFILE_BUCKET_BITS)
+#define PROFILE_DEPTH 64
+#define TASK_SIZE 68
+#define TASK_FLOAT_CELLS 8
+#define IRQ_VECTORS (16 + 86)
+#define IRQ_DATA_CELLS 32
+#define IRQ_RETURN_CELLS 64
+#define FLOAT_CELLS 32
+
+#define STR(x) STR_(x)
+#define STR_(x) #x
+
+/*
+ * The assembler macros that lay out the dictionary. These follow the
+ * ones in forth_system.S.
+ */
+#define HOST_ASM_MACROS \
+  ".set F_IMMED,0x80\n" \
+  ".set F_INLINE,0x40\n" \
+  ".set F_HIDDEN,0x20\n" \
+  ".set F_LENMASK,0x1f\n" \
+  ".set link, 0\n" \
+  \
+  ".macro __defcode label\n" \
+  "    .section .bss\n" \
+  "    .balign 4\n" \
+  "    .globl forth_code_\\label\n" \
+  "forth_code_\\label\\():\n" \
+  "    .space 4\n" \
+  ".endm\n" \
+  \
+  ".macro __defheader name, flags, label\n" \
+  "    .section .rodata.forth_dictionary, \"a\"\n" \
+  "    .balign 4\n" \
+  "    .globl forth_name_\\label\n" \
+  "    .type forth_name_\\label\\(), @object\n" \
+  "forth_name_\\label\\():\n" \
+  "    .4byte link\n" \
+  "    .4byte forth_\\label\\()\n" \
+  "    .set link, forth_name_\\label\n" \
+  "    .byte forth_end_name_\\label\\()-.-1+\\flags\n" \
+  "    .ascii \"\\name\"\n" \
+  "forth_end_name_\\label\\():\n" \
+  "    .balign 4, 0\n" \
+  "    .globl forth_\\label\n" \
+  "    .type forth_\\label\\(), @object\n" \
+  "forth_\\label\\():\n" \
+  ".endm\n" \
+  \
+  ".macro __defnative name, flags, label\n" \
+  "    __defheader \"\\name\",\\flags,\\label\n" \
+  "    .4byte forth_code_\\label\n" \
+  "    __defcode \\label\n" \
+  ".endm\n" \
+  \
+  ".macro __defword name, flags, label\n" \
+  "    __defheader \"\\name\",\\flags,\\label\n" \
+  "    .4byte forth_do_colon\n" \
+  ".endm\n" \
+  \
+  ".macro __defvar name, label, initial\n" \
+  "    __defheader \"\\name\",0,\\label\n" \
+  "    .4byte forth_do_value\n" \
+  "    .4byte forth_var_\\name\n" \
+  "    .section .data\n" \
+  "    .balign 4\n" \
+  "    .globl forth_var_\\name\n" \
+  "forth_var_\\name\\():\n" \
+  "    .4byte \\initial\n" \
+  ".endm\n" \
+  \
+  ".macro __defdata name, initial=0\n" \
+  "    .section .data\n" \
+  "    .balign 4\n" \
+  "    .globl \\name\n" \
+  "\\name\\():\n" \
+  "    .4byte \\initial\n" \
+  ".endm\n"
+
+#define ASM_NATIVE(name, flags, label) "__defnative \"" name "\"," STR(flags) "," #label "\n"
+#define ASM_VAR(name, label, initial) "__defvar " #name "," #label "," STR(initial) "\n"
+#define ASM_WORD(name, flags, label, body) \
+  "__defword \"" name "\"," STR(flags) "," #label "\n" \
+  ".4byte " body ", forth_exit\n"
+
+asm(
+  HOST_ASM_MACROS
+
+  // The user memory, followed by the return stack.
+  ".section .bss\n"
+  ".balign 4\n"
+  ".globl _sheap, _eheap, _sstack, _estack\n"
+  "_sheap:\n"
+  ".space " STR(HEAP_SIZE) "\n"
+  "_eheap:\n"
+  "_sstack:\n"
+  ".space " STR(RETURN_STACK_SIZE) "\n"
+  "_estack:\n"
+
+  ".globl forth_word_buffer\n"
+  "forth_word_buffer:\n"
+  ".space F_LENMASK\n"
+
+  "__defdata forth_dispatch_count\n"
+
+  "__defcode do_colon\n"
+  ".globl forth_do_colon\n"
+  ".set forth_do_colon, forth_code_do_colon\n"
+  "__defcode do_native\n"
+  ".globl forth_do_native\n"
+  ".set forth_do_native, forth_code_do_native\n"
+  "__defcode do_const\n"
+  ".globl forth_do_const\n"
+  ".set forth_do_const, forth_code_do_const\n"
+  "__defcode do_var\n"
+  ".globl forth_do_var\n"
+  ".set forth_do_var, forth_code_do_var\n"
+  "__defcode do_value\n"
+  ".globl forth_do_value\n"
+  ".set forth_do_value, forth_code_do_value\n"
+  "__defcode do_does\n"
+  ".globl forth_do_does\n"
+  ".set forth_do_does, forth_code_do_does\n"
+  "__defcode do_tokens\n"
+  ".globl forth_do_tokens\n"
+  ".set forth_do_tokens, forth_code_do_tokens\n"
+  "__defcode token_resume\n"
+  "__defcode irq_return\n"
+
+  ".section .rodata.forth_dictionary, \"a\"\n"
+  ".balign 4\n"
+  ".globl forth_dictionary_start, forth_dictionary_end\n"
+  "forth_dictionary_start:\n"
+  FORTH_HOST_DICTIONARY(ASM_NATIVE, ASM_VAR, ASM_WORD)
+  ".section .rodata.forth_dictionary, \"a\"\n"
+  "forth_dictionary_end:\n"
+
+  ".section .bss\n"
+  ".globl forth_dictionary_overlay\n"
+  "forth_dictionary_overlay:\n"
+  ".space (forth_dictionary_end-forth_dictionary_start+7)/8\n"
+
+  ".section .bss\n"
+  ".balign 4\n"
+  ".globl forth_find_index_buckets, forth_find_index_nodes\n"
+  "forth_find_index_buckets:\n"
+  ".space 4*" STR(FIND_INDEX_BUCKETS) "\n"
+  "forth_find_index_tails:\n"
+  ".space 4*" STR(FIND_INDEX_BUCKETS) "\n"
+  "forth_find_index_nodes:\n"
+  ".space 8*" STR(FIND_INDEX_NODES) "\n"
+  "forth_find_index_nodes_end:\n"
+  "__defdata forth_find_index_size," STR(FIND_INDEX_BUCKETS) "\n"
+  "__defdata forth_find_index_latest\n"
+  "__defdata forth_find_index_free,forth_find_index_nodes\n"
+  "__defdata forth_find_index_overflow\n"
+  "__defdata forth_find_index_lookups\n"
+  "__defdata forth_find_index_probes\n"
+  "__defdata forth_find_index_rebuilds\n"
+
+  ".section .data\n"
+  ".balign 4\n"
+  ".globl forth_peephole_rules\n"
+  "forth_peephole_rules:\n"
+  ".4byte forth_lit, forth_add, forth_lit_add, 0\n"
+  ".4byte forth_lit, forth_sub, forth_lit_add, 0\n"
+  ".4byte forth_dup, forth_brancheq, forth_dup_brancheq, 0\n"
+  ".4byte forth_swap, forth_drop, forth_nip, 0\n"
+  ".4byte forth_fetch, forth_add, forth_fetch_add, 0\n"
+  ".4byte forth_over, forth_over, forth_2dup, 0\n"
+  "forth_peephole_rules_end:\n"
+  "__defdata forth_peephole_size,(forth_peephole_rules_end-forth_peephole_rules)/16\n"
+  "__defdata forth_peephole_last\n"
+  "__defdata forth_peephole_here\n"
+  "__defdata forth_peephole_fusions\n"
+  "__defdata forth_peephole_immediate_here\n"
+  "__defdata forth_peephole_literals\n"
+  // The routine cells are unused: forth_host_fold_word does the folding.
+  ".globl forth_fold_rules\n"
+  "forth_fold_rules:\n"
+  ".4byte forth_inc, 1, 0, 0\n"
+  ".4byte forth_dec, 1, 0, 0\n"
+  ".4byte forth_inc4, 1, 0, 0\n"
+  ".4byte forth_dec4, 1, 0, 0\n"
+  ".4byte forth_not, 1, 0, 0\n"
+  ".4byte forth_add, 2, 0, 0\n"
+  ".4byte forth_sub, 2, 0, 0\n"
+  ".4byte forth_mul, 2, 0, 0\n"
+  ".4byte forth_div, 2, 0, 0\n"
+  ".4byte forth_and, 2, 0, 0\n"
+  ".4byte forth_or, 2, 0, 0\n"
+  ".4byte forth_xor, 2, 0, 0\n"
+  ".4byte forth_lshift, 2, 0, 0\n"
+  ".4byte forth_rshift, 2, 0, 0\n"
+  "forth_fold_rules_end:\n"
+  "__defdata forth_peephole_fold_size,(forth_fold_rules_end-forth_fold_rules)/16\n"
+  "__defdata forth_peephole_folds\n"
+
+  // The specials are laid out as in forth_system.S.
+  ".section .data\n"
+  ".balign 4\n"
+  ".globl forth_token_table\n"
+  "forth_token_table:\n"
+  ".4byte forth_exit, forth_lit, 0, 0, forth_branch, forth_brancheq\n"
+  ".4byte forth_paren_do, forth_paren_maybe_do, forth_paren_loop, forth_paren_plus_loop, forth_leave\n"
+  ".space 4*(" STR(TOKEN_TABLE_SIZE) "-" STR(TOKEN_SPECIALS) ")\n"
+  "__defdata forth_token_size," STR(TOKEN_TABLE_SIZE) "\n"
+  "__defdata forth_token_count," STR(TOKEN_SPECIALS) "\n"
+  "__defdata forth_token_ip\n"
+  "__defdata forth_token_thread,forth_token_resume\n"
+  "__defdata forth_token_resume,forth_code_token_resume\n"
+
+  // The main task's control block, a ring of one, as in forth_system.S.
+  ".section .data\n"
+  ".balign 4\n"
+  ".globl forth_task_main\n"
+  "forth_task_main:\n"
+  ".4byte forth_task_main, 1\n"
+  ".space " STR(TASK_SIZE) "-8\n"
+  "__defdata forth_task_current,forth_task_main\n"
+
+  // The interrupt stacks, and the words bound to each vector.
+  ".section .bss\n"
+  ".balign 8\n"
+  ".globl forth_irq_words\n"
+  "forth_irq_words:\n"
+  ".space 4*" STR(IRQ_VECTORS) "\n"
+  "forth_irq_data_stack:\n"
+  ".space 4*(" STR(IRQ_DATA_CELLS) "+1)\n"
+  ".balign 8\n"
+  ".space 4*" STR(IRQ_RETURN_CELLS) "\n"
+  "forth_irq_return_stack_end:\n"
+  "__defdata forth_irq_return,forth_code_irq_return\n"
+
+  // The float stack, with a cell under the bottom for ftos.
+  ".section .bss\n"
+  ".balign 4\n"
+  ".globl forth_float_stack\n"
+  "forth_float_stack:\n"
+  ".space 4*(" STR(FLOAT_CELLS) "+1)\n"
+  "__defdata forth_fsp,forth_float_stack\n"
+
+  ".section .bss\n"
+  ".balign 4\n"
+  ".globl forth_tib\n"
+  "forth_tib:\n"
+  ".space " STR(TIB_SIZE) "\n"
+  "__defdata forth_source_tib_count\n"
+  "__defdata forth_source_tib_received\n"
+  "__defdata forth_source_in\n"
+
+  ".section .bss\n"
+  ".balign 4\n"
+  ".globl forth_output_buffer\n"
+  "forth_output_buffer:\n"
+  ".space " STR(OUTPUT_BUFFER_SIZE) "\n"
+  "__defdata forth_output_head\n"
+  "__defdata forth_output_tail\n"
+
+#ifdef FORTH_PROFILE
+  ".section .bss\n"
+  ".balign 8\n"
+  ".globl forth_profile_records, forth_profile_order\n"
+  "forth_profile_records:\n"
+  ".space 24*" STR(PROFILE_RECORDS) "\n"
+  "forth_profile_buckets:\n"
+  ".space 4*" STR(PROFILE_BUCKETS) "\n"
+  "forth_profile_order:\n"
+  ".space 4*" STR(PROFILE_RECORDS) "\n"
+  "forth_profile_frames:\n"
+  ".space 12*" STR(PROFILE_DEPTH) "\n"
+  "__defdata forth_profile_count\n"
+  "__defdata forth_profile_depth\n"
+  "__defdata forth_profile_dropped\n"
+#endif
+  ".text\n"
+);
+
+#define DECLARE_NATIVE(name, flags, label) extern uint32_t forth_code_##label;
+#define DECLARE_NONE(...)
+
+extern "C" {
+FORTH_HOST_DICTIONARY(DECLARE_NATIVE, DECLARE_NONE, DECLARE_NONE)
+extern uint32_t forth_code_do_colon;
+extern uint32_t forth_code_do_native;
+extern uint32_t forth_code_do_const;
+extern uint32_t forth_code_do_var;
+extern uint32_t forth_code_do_value;
+extern uint32_t forth_code_do_does;
+extern uint32_t forth_code_do_tokens;
+extern uint32_t forth_code_token_resume;
+extern uint32_t forth_code_irq_return;
+extern uint32_t forth_irq_data_stack;
+extern uint32_t forth_irq_return_stack_end;
+extern uint32_t forth_irq_return;
+extern uint32_t forth_token_thread;
+extern uint32_t forth_peephole_here;
+extern uint32_t forth_peephole_last;
+extern uint32_t forth_peephole_immediate_here;
+extern uint32_t forth_find_index_free;
+extern uint32_t forth_find_index_latest;
+extern uint32_t forth_find_index_nodes_end;
+extern uint32_t forth_find_index_tails;
+extern uint32_t forth_peephole_rules_end;
+extern uint32_t forth_fold_rules_end;
+extern uint32_t forth_peephole_literals;
+extern uint32_t forth_profile_buckets;
+extern uint32_t forth_profile_frames;
+extern char forth_word_buffer;
+}
+
+static constexpr uint32_t F_IMMED = 0x80;
+static constexpr uint32_t F_INLINE = 0x40;
+static constexpr uint32_t F_HIDDEN = 0x20;
+static constexpr uint32_t F_LENMASK = 0x1f;
+
+static constexpr uint32_t THREADING_INDIRECT = 0;
+static constexpr uint32_t THREADING_NATIVE = 1;
+static constexpr uint32_t THREADING_TOKEN = 2;
+
+/* The tokens that forth_token_next runs itself, as in forth_system.S. */
+enum : uint32_t {
+  TOKEN_EXIT,
+  TOKEN_LIT,
+  TOKEN_LIT16,
+  TOKEN_CALL,
+  TOKEN_BRANCH,
+  TOKEN_BRANCHEQ,
+  TOKEN_DO,
+  TOKEN_MAYBE_DO,
+  TOKEN_LOOP,
+  TOKEN_PLUS_LOOP,
+  TOKEN_LEAVE,
+};
+static constexpr uint32_t TOKEN_RELATIVE = 0x8000;
+
+/* The cells of a task control block, as in forth_system.S. */
+enum : uint32_t {
+  TASK_LINK,
+  TASK_AWAKE,
+  TASK_PSP,
+  TASK_IP,
+  TASK_RSP,
+  TASK_TOKEN_IP,
+  TASK_BASE,
+  TASK_STATE,
+  TASK_S0,
+  TASK_R0,
+  TASK_THREAD,
+  TASK_F0 = TASK_THREAD + 4,
+  TASK_FTOS,
+  TASK_FSP,
+};
+static_assert(TASK_SIZE == 4 * (TASK_FSP + 1), "TASK_SIZE");
+
+static constexpr uint32_t FLUSH_ON_NEWLINE = 0;
+static constexpr uint32_t FLUSH_ON_IDLE = 1;
+static constexpr uint32_t FLUSH_WHEN_FULL = 2;
+
+/* Converts between Forth addresses and C pointers. */
+static inline uint32_t *cell_at(uint32_t addr) {
+  return (uint32_t *)(uintptr_t)addr;
+}
+
+static inline uint8_t *byte_at(uint32_t addr) {
+  return (uint8_t *)(uintptr_t)addr;
+}
+
+static inline uint16_t *halfword_at(uint32_t addr) {
+  return (uint16_t *)(uintptr_t)addr;
+}
+
+static inline uint32_t addr_of(const void *ptr) {
+  return (uint32_t)(uintptr_t)ptr;
+}
+
+/* Division the way the Cortex-M4's sdiv does it: x/0 is 0, and nothing traps. */
+static inline int32_t forth_sdiv(int32_t x, int32_t y) {
+  if (y == 0) return 0;
+  if (y == -1) return (int32_t)(0u - (uint32_t)x);
+  return x / y;
+}
+
+/*
+ * Divides a double by a cell the way _forth_um_divmod does: if the
+ * quotient doesn't fit in a cell, both results are all ones.
+ */
+static void forth_host_um_divmod(uint64_t d, uint32_t u, uint32_t *quot, uint32_t *rem) {
+  if ((d >> 32) >= u) {
+    *quot = *rem = 0xffffffff;
+    return;
+  }
+  *quot = (uint32_t)(d / u);
+  *rem = (uint32_t)(d % u);
+}
+
+/* And symmetric division, like _forth_sm_divmod. */
+static void forth_host_sm_divmod(uint64_t d, uint32_t n, uint32_t *quot, uint32_t *rem) {
+  bool negative = (int64_t)d < 0;
+  bool negative_n = (int32_t)n < 0;
+  forth_host_um_divmod(negative ? 0 - d : d, negative_n ? 0 - n : n, quot, rem);
+  if (negative) *rem = 0 - *rem;
+  if (negative != negative_n) *quot = 0 - *quot;
+}
+
+/* Floats live on the float stack and in memory as their bits. */
+static inline float float_of(uint32_t bits) {
+  float x;
+  memcpy(&x, &bits, 4);
+  return x;
+}
+
+static inline uint32_t bits_of(float x) {
+  uint32_t bits;
+  memcpy(&bits, &x, 4);
+  return bits;
+}
+
+/* Conversion the way vcvt.s32.f32 does it: toward zero, saturating, and NaN is 0. */
+static inline int32_t forth_f32_to_s32(float x) {
+  if (x != x) return 0;
+  if (x >= 2147483648.0f) return INT32_MAX;
+  if (x <= -2147483648.0f) return INT32_MIN;
+  return (int32_t)x;
+}
+
+/* Loads an array element of 1, 2 or 4 bytes, sign extended. */
+static inline int32_t forth_host_element(uint32_t addr, uint32_t size) {
+  if (size == 1) return (int8_t)*byte_at(addr);
+  if (size == 2) return (int16_t)*halfword_at(addr);
+  return (int32_t)*cell_at(addr);
+}
+
+/* The element-wise vector words: dst[i] <- op(src1[i], src2[i]). */
+static void forth_host_vector(uint32_t src1, uint32_t src2, uint32_t dst, uint32_t count,
+                              uint32_t size, uint32_t (*op)(int32_t, int32_t)) {
+  for (uint32_t i = 0; i < count * size; i += size) {
+    uint32_t x = op(forth_host_element(src1 + i, size), forth_host_element(src2 + i, size));
+    memcpy(byte_at(dst + i), &x, size); // the low bytes, little endian like the board
+  }
+}
+
+static uint32_t forth_host_vadd(int32_t x, int32_t y) { return (uint32_t)x + (uint32_t)y; }
+static uint32_t forth_host_vsub(int32_t x, int32_t y) { return (uint32_t)x - (uint32_t)y; }
+static uint32_t forth_host_vmul(int32_t x, int32_t y) { return (uint32_t)x * (uint32_t)y; }
+
+/* Saturating adds, like qadd16 and qadd8 do for each lane. */
+static uint32_t forth_host_vqadd16(int32_t x, int32_t y) {
+  int32_t z = x + y;
+  return (uint32_t)(z > 0x7fff ? 0x7fff : z < -0x8000 ? -0x8000 : z);
+}
+
+static uint32_t forth_host_vqadd8(int32_t x, int32_t y) {
+  int32_t z = x + y;
+  return (uint32_t)(z > 0x7f ? 0x7f : z < -0x80 ? -0x80 : z);
+}
+
+/* Hands the output buffer to usb_serial_write, like _forth_write_output. */
+static void forth_host_write_output() {
+  while (forth_output_tail != forth_output_head) {
+    uint32_t offset = forth_output_head & (OUTPUT_BUFFER_SIZE - 1);
+    uint32_t len = forth_output_tail - forth_output_head;
+    if (len > OUTPUT_BUFFER_SIZE - offset) len = OUTPUT_BUFFER_SIZE - offset;
+    forth_output_head += len;
+    usb_serial_write((uint8_t *)&forth_output_buffer + offset, len);
+  }
+}
+
+/* Subroutine version of FLUSH. */
+extern "C" void forth_flush_output() {
+  forth_host_write_output();
+  usb_serial_flush_output();
+}
+
+/* Subroutine version of EMIT. */
+static void forth_host_emit(uint8_t c) {
+  ((uint8_t *)&forth_output_buffer)[forth_output_tail++ & (OUTPUT_BUFFER_SIZE - 1)] = c;
+  if (forth_output_tail - forth_output_head == OUTPUT_BUFFER_SIZE) {
+    forth_host_write_output();
+  } else if (c == 10 && forth_var_FLUSH_POLICY == FLUSH_ON_NEWLINE) {
+    forth_flush_output();
+  }
+}
+
+/* Subroutine version of TYPE. */
+static void forth_host_type(const uint8_t *s, uint32_t len) {
+  if (len < OUTPUT_BUFFER_SIZE) {
+    for (uint32_t i = 0; i < len; i++) forth_host_emit(s[i]);
+    return;
+  }
+  forth_host_write_output();
+  usb_serial_write(s, len);
+  if (forth_var_FLUSH_POLICY == FLUSH_ON_NEWLINE && memchr(s, 10, len) != nullptr) {
+    usb_serial_flush_output();
+  }
+}
+
+/* Finds the unparsed part of the input source, like _forth_source_span. */
+static void forth_host_source_span(uint32_t *next, uint32_t *end) {
+  uint32_t base = forth_var_STDIN != 0 ? forth_var_STDIN : addr_of(&forth_tib);
+  uint32_t len = forth_var_STDIN != 0 ? forth_var_STDIN_COUNT : forth_source_tib_count;
+  *end = base + len;
+  *next = forth_source_in < len ? base + forth_source_in : *end;
+}
+
+/* Marks the input source as parsed up to next, like _forth_source_advance. */
+static void forth_host_source_advance(uint32_t next, uint32_t end) {
+  if (forth_var_STDIN != 0) {
+    forth_var_STDIN = next;
+    forth_var_STDIN_COUNT = end - next;
+    forth_source_in = 0;
+  } else {
+    forth_source_in = next - addr_of(&forth_tib);
+  }
+}
+
+/* Flushes output, unless FLUSH_POLICY says not to, before waiting for serial. */
+static void forth_host_idle() {
+  if (forth_var_FLUSH_POLICY != FLUSH_WHEN_FULL) forth_flush_output();
+}
+
+/*
+ * Subroutine version of REFILL. Returns -1 if refilled, or 0 if the source is
+ * memory. Like _forth_refill, this drops the current line from the TIB, then
+ * waits for serial until there is a whole line in it.
+ */
+static uint32_t forth_host_refill() {
+  if (forth_var_STDIN != 0) return 0;
+  uint8_t *tib = (uint8_t *)&forth_tib;
+  uint32_t received = forth_source_tib_received - forth_source_tib_count;
+  memmove(tib, tib + forth_source_tib_count, received);
+  uint32_t searched = 0;
+  while (true) {
+    uint8_t *newline = (uint8_t *)memchr(tib + searched, '\n', received - searched);
+    if (newline != nullptr) {
+      searched = newline + 1 - tib;
+      break;
+    }
+    searched = received;
+    if (received == TIB_SIZE) break;
+
+    int c;
+    forth_host_idle();
+    while ((c = usb_serial_getchar()) == -1) {}
+    tib[received++] = c;
+    uint32_t len = usb_serial_available();
+    if (len > TIB_SIZE - received) len = TIB_SIZE - received;
+    if (len != 0) received += usb_serial_read(tib + received, len);
+  }
+  forth_source_tib_received = received;
+  forth_source_tib_count = searched;
+  forth_source_in = 0;
+  return 0xffffffff;
+}
+
+/* Subroutine version of KEY. Returns the key, or -1 on EOF. */
+static uint32_t forth_host_key() {
+  uint32_t next, end;
+  forth_host_source_span(&next, &end);
+  if (next != end) {
+    uint32_t c = *byte_at(next);
+    forth_host_source_advance(next + 1, end);
+    return c;
+  }
+  if (forth_var_STDIN != 0) return 0xffffffff;
+  if (forth_source_tib_count != forth_source_tib_received) {
+    // The line now includes the key.
+    forth_source_in = ++forth_source_tib_count;
+    return ((uint8_t *)&forth_tib)[forth_source_tib_count - 1];
+  }
+  forth_source_tib_count = forth_source_tib_received = forth_source_in = 0;
+  int c;
+  forth_host_idle();
+  while ((c = usb_serial_getchar()) == -1) {}
+  return c;
+}
+
+/* Subroutine version of ACCEPT. Returns the number of bytes read. */
+static uint32_t forth_host_accept(uint32_t addr, uint32_t len) {
+  uint32_t n = 0;
+  while (n != len) {
+    uint32_t c = forth_host_key();
+    if (c == 0xffffffff || c == '\n') break;
+    *byte_at(addr + n++) = c;
+  }
+  return n;
+}
+
+static inline bool forth_host_is_space(uint32_t c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/* Subroutine version of WORD. Returns the length; the word is in forth_word_buffer. */
+static uint32_t forth_host_word() {
+  uint8_t *buffer = (uint8_t *)&forth_word_buffer;
+  uint32_t len = 0;
+  uint32_t next, end;
+  bool in_word = false;
+  bool comment = false;
+
+  forth_host_source_span(&next, &end);
+  while (true) {
+    if (next == end) {
+      forth_host_source_advance(next, end);
+      if (!forth_host_refill()) return len;
+      forth_host_source_span(&next, &end);
+      continue;
+    }
+    uint32_t c = *byte_at(next++);
+    if (comment) {
+      comment = c != '\n';
+    } else if (forth_host_is_space(c)) {
+      if (in_word) break;
+    } else if (c == '\\' && !in_word) {
+      comment = true;
+    } else {
+      in_word = true;
+      if (len != F_LENMASK) buffer[len++] = c; // We ignore anything that would overflow the buffer
+    }
+  }
+  forth_host_source_advance(next, end);
+  return len;
+}
+
+/*
+ * Subroutine version of PARSE-NAME. Returns the address of the name in the
+ * input source, and its length in *len.
+ */
+static uint32_t forth_host_parse_name(uint32_t *len) {
+  uint32_t next, end;
+  uint32_t start = 0;
+  bool in_name = false;
+  bool comment = false;
+
+  forth_host_source_span(&next, &end);
+  while (true) {
+    if (next == end) {
+      if (!in_name) {
+        forth_host_source_advance(next, end);
+        if (forth_host_refill()) {
+          forth_host_source_span(&next, &end);
+          continue;
+        }
+        *len = 0;
+        return next;
+      }
+      // Like _forth_parse_name, keep a name that runs past the end of a
+      // line too long for the TIB, unless the name fills the TIB.
+      if (forth_var_STDIN != 0 || start == addr_of(&forth_tib)) break;
+      forth_source_tib_count = start - addr_of(&forth_tib);
+      forth_host_refill();
+      forth_host_source_span(&next, &end);
+      in_name = false;
+      continue;
+    }
+    uint32_t c = *byte_at(next++);
+    if (comment) {
+      comment = c != '\n';
+    } else if (forth_host_is_space(c)) {
+      if (in_name) {
+        forth_host_source_advance(next, end);
+        *len = next - 1 - start;
+        return start;
+      }
+    } else if (c == '\\' && !in_name) {
+      comment = true;
+    } else if (!in_name) {
+      in_name = true;
+      start = next - 1;
+    }
+  }
+  forth_host_source_advance(next, end);
+  *len = next - start;
+  return start;
+}
+
+/*
+ * Subroutine version of NUMBER. Returns the number, and the unconverted char count in *left,
+ * which is at least 1 if there are no digits.
+ */
+static uint64_t forth_host_number(uint32_t buff_addr, uint32_t len, uint32_t *left,
+                                  bool *is_double) {
+  const uint8_t *ptr = byte_at(buff_addr);
+  const uint32_t all = len;
+  bool negative = false;
+  bool digits = false;
+  uint64_t number = 0;
+  uint32_t base = forth_var_BASE;
+  *is_double = false;
+
+  if (len != 0) {
+    if (*ptr == '-') {
+      negative = true;
+      ptr++;
+      len--;
+    } else if (*ptr == '$') {
+      base = 16;
+      ptr++;
+      len--;
+    }
+  }
+
+  for (; len != 0; len--) {
+    uint32_t digit = *ptr++;
+    if (digit == '.') {
+      if (*is_double) break; // a second '.' isn't part of the number
+      *is_double = true;
+      continue;
+    }
+    if (digit < '0') break;
+    if (digit <= '9') {
+      digit -= '0';
+    } else {
+      if (digit >= 'a') digit -= 0x20; // converts lower case to upper case
+      if (digit < 'A') break;
+      digit -= 'A' - 10;
+    }
+    if (digit >= base) break;
+    number = number * base + digit;
+    digits = true;
+  }
+
+  if (!digits) {
+    *left = all != 0 ? all : 1; // not even an empty string is a number
+    return 0;
+  }
+  *left = len;
+  return negative ? 0 - number : number;
+}
+
+/*
+ * Converts a float, like 1.5E3 or -2E-1, as _forth_float does, down to
+ * scaling by the same powers of 10 in the same order, so that the host
+ * gets the same bits as the board.
+ */
+static bool forth_host_float(uint32_t buff_addr, uint32_t len, float *result) {
+  static const float powers[] = {1e1f, 1e2f, 1e4f, 1e8f, 1e16f, 1e32f};
+  const uint8_t *ptr = byte_at(buff_addr);
+  bool negative = false, point = false, digits = false;
+  uint32_t mantissa = 0;
+  int32_t scale = 0;
+
+  if (forth_var_BASE != 10 || len == 0) return false;
+  if (*ptr == '-') {
+    negative = true;
+    ptr++;
+    len--;
+  }
+  for (;; len--) {
+    if (len == 0) return false; // no E
+    uint32_t c = *ptr++;
+    if (c == '.') {
+      if (point) return false;
+      point = true;
+      continue;
+    }
+    if (c - '0' > 9) {
+      if ((c | 0x20) != 'e' || !digits) return false;
+      len--;
+      break;
+    }
+    digits = true;
+    if (mantissa < 100000000) {
+      mantissa = mantissa * 10 + (c - '0');
+      if (point) scale--;
+    } else if (!point) {
+      scale++;
+    }
+  }
+
+  uint32_t exponent = 0;
+  bool negative_exponent = false;
+  if (len != 0 && (*ptr == '-' || *ptr == '+')) {
+    negative_exponent = *ptr == '-';
+    ptr++;
+    len--;
+  }
+  for (; len != 0; len--) {
+    uint32_t digit = *ptr++ - '0';
+    if (digit > 9) return false;
+    if (exponent < 1000) exponent = exponent * 10 + digit;
+  }
+  scale += negative_exponent ? -(int32_t)exponent : (int32_t)exponent;
+
+  float x = (float)mantissa;
+  if (mantissa != 0) {
+    uint32_t n = scale < 0 ? -scale : scale;
+    if (n > 63) n = 63;
+    float power = 1.0f;
+    for (const float *p = powers; n != 0; n >>= 1, p++) {
+      if (n & 1) power *= *p;
+    }
+    x = scale < 0 ? x / power : x * power;
+  }
+  *result = negative ? -x : x;
+  return true;
+}
+
+/* Hashes a name to find its bucket in the FIND index. */
+static uint32_t *forth_host_find_hash(const uint8_t *name, uint32_t len) {
+  uint32_t h = len;
+  for (uint32_t i = 0; i < len; i++) h = (h * 33) ^ name[i];
+  h ^= h >> 8; // fold the high bits into the bucket number
+  return &forth_find_index_buckets + (h & (FIND_INDEX_BUCKETS - 1));
+}
+
+/* The len + flags byte of a definition, through the overlay for builtins, like __loadflags. */
+static uint8_t *forth_host_flags(uint32_t defn) {
+  if (defn >= addr_of(&forth_dictionary_end)) return byte_at(defn + 8);
+  return &forth_dictionary_overlay[(defn - addr_of(&forth_dictionary_start)) >> 3];
+}
+
+static uint32_t forth_host_load_flags(uint32_t defn) {
+  uint32_t flags = *byte_at(defn + 8);
+  if (defn < addr_of(&forth_dictionary_end)) flags ^= *forth_host_flags(defn);
+  return flags;
+}
+
+/* Compares the name of a definition with the given name, like _forth_find_match. */
+static bool forth_host_find_match(uint32_t defn, const uint8_t *name, uint32_t len) {
+  if ((forth_host_load_flags(defn) & (F_HIDDEN | F_LENMASK)) != len) return false;
+  return memcmp(byte_at(defn + 9), name, len) == 0;
+}
+
+/* Rebuilds the FIND index by walking the dictionary from LATEST. */
+static void forth_host_find_index_rebuild() {
+  uint32_t *tails = &forth_find_index_tails;
+  uint32_t *node = &forth_find_index_nodes;
+  uint32_t *nodes_end = &forth_find_index_nodes_end;
+  uint32_t overflow = 0;
+
+  forth_find_index_rebuilds++;
+  for (uint32_t i = 0; i < FIND_INDEX_BUCKETS; i++) {
+    (&forth_find_index_buckets)[i] = 0;
+    tails[i] = addr_of(&forth_find_index_buckets + i);
+  }
+
+  for (uint32_t defn = forth_var_LATEST; defn != 0; defn = *cell_at(defn)) {
+    if (node == nodes_end) {
+      overflow = 1;
+      break;
+    }
+    uint32_t bucket = forth_host_find_hash(byte_at(defn + 9), *byte_at(defn + 8) & F_LENMASK)
+        - &forth_find_index_buckets;
+    *cell_at(tails[bucket]) = addr_of(node);
+    tails[bucket] = addr_of(node);
+    node[0] = 0;
+    node[1] = defn;
+    node += 2;
+  }
+
+  forth_find_index_overflow = overflow;
+  forth_find_index_free = addr_of(node);
+  forth_find_index_latest = forth_var_LATEST;
+}
+
+/* Adds LATEST to the front of its bucket in the FIND index, like _forth_find_index_add. */
+static void forth_host_find_index_add(uint32_t previous_latest) {
+  if (forth_find_index_latest != previous_latest) {
+    forth_find_index_latest = 0;
+    return;
+  }
+  if (forth_find_index_overflow == 0) {
+    if (forth_find_index_free == addr_of(&forth_find_index_nodes_end)) {
+      forth_find_index_overflow = 1;
+    } else {
+      uint32_t *node = cell_at(forth_find_index_free);
+      uint32_t *bucket = forth_host_find_hash(byte_at(forth_var_LATEST + 9),
+          *byte_at(forth_var_LATEST + 8) & F_LENMASK);
+      node[0] = *bucket;
+      node[1] = forth_var_LATEST;
+      *bucket = addr_of(node);
+      forth_find_index_free += 8;
+    }
+  }
+  forth_find_index_latest = forth_var_LATEST;
+}
+
+/* Subroutine version of FIND. Returns the definition address, or 0 if not found. */
+static uint32_t forth_host_find(uint32_t buff_addr, uint32_t len) {
+  const uint8_t *name = byte_at(buff_addr);
+  if (len > F_LENMASK) len = F_LENMASK; // as CREATE only keeps that many
+
+  forth_find_index_lookups++;
+  if (forth_var_LATEST != forth_find_index_latest) forth_host_find_index_rebuild();
+  if (forth_find_index_overflow) {
+    for (uint32_t defn = forth_var_LATEST; defn != 0; defn = *cell_at(defn)) {
+      if (forth_host_find_match(defn, name, len)) return defn;
+    }
+    return 0;
+  }
+  for (uint32_t node = *forth_host_find_hash(name, len); node != 0; node = *cell_at(node)) {
+    forth_find_index_probes++;
+    uint32_t defn = cell_at(node)[1];
+    if (forth_host_find_match(defn, name, len)) return defn;
+  }
+  return 0;
+}
+
+/* Subroutine version of , */
+static inline void forth_host_store_to_here(uint32_t x) {
+  *cell_at(forth_var_HERE) = x;
+  forth_var_HERE += 4;
+}
+
+/* Stores the low half of x at HERE, like _forth_store_halfword_to_here. */
+static inline void forth_host_store_halfword_to_here(uint32_t x) {
+  *halfword_at(forth_var_HERE) = (uint16_t)x;
+  forth_var_HERE += 2;
+}
+
+/* Tries to fuse a word with the last word or literal compiled, like _forth_peephole_fuse. */
+static bool forth_host_peephole_fuse(uint32_t cfa) {
+  if (forth_peephole_here != forth_var_HERE) return false;
+  uint32_t *last = cell_at(forth_peephole_last);
+  for (uint32_t *rule = &forth_peephole_rules; rule != &forth_peephole_rules_end; rule += 4) {
+    if (rule[0] != last[0] || rule[1] != cfa) continue;
+    last[0] = rule[2];
+    rule[3]++;
+    forth_peephole_fusions++;
+    if (cfa == addr_of(&forth_sub)) last[1] = 0 - last[1]; // LIT <n> - is LIT+ <-n>
+    return true;
+  }
+  return false;
+}
+
+/* Shifts like LSHIFT and RSHIFT do, giving 0 from 32 on. */
+static inline uint32_t forth_host_lshift(uint32_t x, uint32_t u) {
+  return u >= 32 ? 0 : x << u;
+}
+
+static inline uint32_t forth_host_rshift(uint32_t x, uint32_t u) {
+  return u >= 32 ? 0 : x >> u;
+}
+
+/* What a foldable word leaves for x (and y, if it takes two). */
+static uint32_t forth_host_fold_word(uint32_t cfa, uint32_t x, uint32_t y) {
+  if (cfa == addr_of(&forth_inc)) return x + 1;
+  if (cfa == addr_of(&forth_dec)) return x - 1;
+  if (cfa == addr_of(&forth_inc4)) return x + 4;
+  if (cfa == addr_of(&forth_dec4)) return x - 4;
+  if (cfa == addr_of(&forth_not)) return ~x;
+  if (cfa == addr_of(&forth_add)) return x + y;
+  if (cfa == addr_of(&forth_sub)) return x - y;
+  if (cfa == addr_of(&forth_mul)) return x * y;
+  if (cfa == addr_of(&forth_div)) return forth_sdiv(x, y);
+  if (cfa == addr_of(&forth_and)) return x & y;
+  if (cfa == addr_of(&forth_or)) return x | y;
+  if (cfa == addr_of(&forth_xor)) return x ^ y;
+  if (cfa == addr_of(&forth_lshift)) return forth_host_lshift(x, y);
+  return forth_host_rshift(x, y);
+}
+
+/* Tries to fold a word into the literals compiled just before it, like _forth_fold. */
+static bool forth_host_fold(uint32_t cfa) {
+  if (forth_peephole_here != forth_var_HERE) return false;
+  if (*cell_at(forth_peephole_last) != addr_of(&forth_lit)) return false;
+  for (uint32_t *rule = &forth_fold_rules; rule != &forth_fold_rules_end; rule += 4) {
+    if (rule[0] != cfa) continue;
+    uint32_t inputs = rule[1];
+    if (forth_peephole_literals < inputs) return false;
+    forth_peephole_literals -= inputs - 1; // the result is a literal too
+    rule[3]++;
+    forth_peephole_folds++;
+    uint32_t *last = cell_at(forth_var_HERE - 4);
+    if (inputs == 2) {
+      last[-2] = forth_host_fold_word(cfa, last[-2], last[0]);
+      forth_var_HERE -= 8;
+    } else {
+      last[0] = forth_host_fold_word(cfa, last[0], 0);
+    }
+    forth_peephole_here = forth_var_HERE;
+    forth_peephole_last = forth_var_HERE - 8;
+    return true;
+  }
+  return false;
+}
+
+/* Remembers where the word or literal just compiled is, like _forth_peephole_mark. */
+static inline void forth_host_peephole_mark(uint32_t addr) {
+  forth_peephole_last = addr;
+  forth_peephole_here = forth_var_HERE;
+}
+
+/* Lays down the token for a word at HERE, like _forth_compile_token. */
+static void forth_host_compile_token(uint32_t cfa) {
+  uint32_t *table = &forth_token_table;
+  for (uint32_t token = 0; token != forth_token_count; token++) {
+    if (table[token] != cfa) continue;
+    forth_host_store_halfword_to_here(token);
+    return;
+  }
+  uint32_t back = ((forth_var_HERE + 2) & ~3u) - cfa;
+  if (back < TOKEN_RELATIVE * 4) { // a word ahead wraps around to a big number
+    forth_host_store_halfword_to_here(TOKEN_RELATIVE | (back >> 2));
+    return;
+  }
+  if (forth_token_count != forth_token_size) {
+    table[forth_token_count] = cfa;
+    forth_host_store_halfword_to_here(forth_token_count++);
+    return;
+  }
+  forth_host_store_halfword_to_here(TOKEN_CALL);
+  forth_host_store_halfword_to_here(cfa);
+  forth_host_store_halfword_to_here(cfa >> 16);
+}
+
+/* Compiles a call to a word into the definition at HERE. */
+static void forth_host_compile_word(uint32_t cfa) {
+  if (forth_var_THREADING == THREADING_TOKEN) {
+    forth_host_compile_token(cfa);
+    return;
+  }
+  if (forth_host_fold(cfa)) return;
+  if (forth_host_peephole_fuse(cfa)) return;
+  uint32_t addr = forth_var_HERE;
+  forth_host_store_to_here(cfa);
+  forth_host_peephole_mark(addr);
+}
+
+/* How big a branch offset is: a cell, or a token in token threaded code. */
+static inline uint32_t forth_host_offset_size() {
+  return forth_var_THREADING == THREADING_TOKEN ? 2 : 4;
+}
+
+/* Lays down an offset to fill in, and returns its address, like _forth_mark_forward. */
+static uint32_t forth_host_mark_forward() {
+  uint32_t addr = forth_var_HERE;
+  if (forth_host_offset_size() == 2) {
+    forth_host_store_halfword_to_here(0);
+  } else {
+    forth_host_store_to_here(0);
+  }
+  return addr;
+}
+
+/* Makes the offset at addr go to HERE, like _forth_resolve_forward. */
+static void forth_host_resolve_forward(uint32_t addr) {
+  uint32_t size = forth_host_offset_size();
+  uint32_t offset = (forth_var_HERE - addr - size) / size;
+  if (size == 2) {
+    *halfword_at(addr) = (uint16_t)offset;
+  } else {
+    *cell_at(addr) = offset;
+  }
+}
+
+/* Lays down an offset that goes back to addr, like _forth_resolve_backward. */
+static void forth_host_resolve_backward(uint32_t addr) {
+  uint32_t size = forth_host_offset_size();
+  int32_t offset = ((int32_t)(addr - forth_var_HERE) - (int32_t)size) / (int32_t)size;
+  if (size == 2) {
+    forth_host_store_halfword_to_here(offset);
+  } else {
+    forth_host_store_to_here(offset);
+  }
+}
+
+/* Compiles (DO) or (?DO) and an offset to fill in, like _forth_compile_do. */
+static uint32_t forth_host_compile_do(uint32_t cfa) {
+  forth_host_compile_word(cfa);
+  return forth_host_mark_forward();
+}
+
+/* Compiles (LOOP) or (+LOOP) and fills in DO's offset, like _forth_compile_loop. */
+static void forth_host_compile_loop(uint32_t cfa, uint32_t do_addr) {
+  forth_host_compile_word(cfa);
+  forth_host_resolve_backward(do_addr + forth_host_offset_size());
+  forth_host_resolve_forward(do_addr);
+}
+
+/* Whether a call to a word can be compiled as a tail call, like _forth_can_tail_call. */
+static bool forth_host_can_tail_call(uint32_t cfa) {
+  return forth_var_TAIL_CALLS == 1 && forth_var_THREADING == THREADING_INDIRECT &&
+      *cell_at(cfa) == addr_of(&forth_code_do_colon);
+}
+
+/* Compiles (TAIL) <cfa>, or the word and EXIT, like _forth_compile_tail_call. */
+static void forth_host_compile_tail_call(uint32_t cfa) {
+  if (forth_host_can_tail_call(cfa)) {
+    forth_host_store_to_here(addr_of(&forth_paren_tail));
+    forth_host_store_to_here(cfa);
+  } else {
+    forth_host_compile_word(cfa);
+    forth_host_compile_word(addr_of(&forth_exit));
+  }
+}
+
+/* Turns the word compiled just before ; into a tail call, like _forth_tail_call_last. */
+static bool forth_host_tail_call_last() {
+  if (forth_peephole_immediate_here != forth_var_HERE) return false;
+  if (forth_peephole_last + 4 != forth_var_HERE) return false;
+  uint32_t cfa = *cell_at(forth_peephole_last);
+  if (!forth_host_can_tail_call(cfa)) return false;
+  *cell_at(forth_peephole_last) = addr_of(&forth_paren_tail);
+  forth_host_store_to_here(cfa);
+  return true;
+}
+
+/*
+ * How much a colon word's body would take up inlined, like
+ * _forth_inline_length: the bytes it takes, or -1 if it can't be inlined
+ * or takes more than most. *tail is the word a (TAIL) at the end jumps to.
+ */
+static uint32_t forth_host_inline_length(uint32_t cfa, uint32_t most, uint32_t *tail) {
+  *tail = 0;
+  if (*cell_at(cfa) != addr_of(&forth_code_do_colon)) return 0xffffffff;
+  uint32_t start = cfa + 4;
+  uint32_t furthest = start; // the furthest anything branches to
+  for (uint32_t addr = start; addr - start <= most; ) {
+    uint32_t word = *cell_at(addr);
+    addr += 4;
+    if (word == addr_of(&forth_exit)) {
+      if (furthest > addr - 4) return 0xffffffff;
+      return addr - 4 - start;
+    }
+    if (word == addr_of(&forth_paren_tail)) {
+      if (furthest > addr - 4 || addr - start > most) return 0xffffffff;
+      *tail = *cell_at(addr);
+      return addr - start; // the body, and a call to the word
+    }
+    if (word == addr_of(&forth_paren_does)) return 0xffffffff;
+    // Words that use the return stack would see the caller's frame.
+    if (word == addr_of(&forth_param_to_return) || word == addr_of(&forth_return_to_param) ||
+        word == addr_of(&forth_fetch_return) || word == addr_of(&forth_store_return) ||
+        word == addr_of(&forth_i) || word == addr_of(&forth_j) ||
+        word == addr_of(&forth_leave) || word == addr_of(&forth_unloop)) {
+      return 0xffffffff;
+    }
+    if (word == addr_of(&forth_lit) || word == addr_of(&forth_lit_add)) {
+      addr += 4;
+    } else if (word == addr_of(&forth_branch) || word == addr_of(&forth_brancheq) ||
+        word == addr_of(&forth_dup_brancheq) || word == addr_of(&forth_paren_do) ||
+        word == addr_of(&forth_paren_maybe_do) || word == addr_of(&forth_paren_loop) ||
+        word == addr_of(&forth_paren_plus_loop)) {
+      addr += 4;
+      uint32_t target = addr + ((int32_t)*cell_at(addr - 4) << 2);
+      if (target > furthest) furthest = target;
+    }
+  }
+  return 0xffffffff;
+}
+
+extern "C" uint32_t forth_inline_length(uint32_t cfa, uint32_t most) {
+  uint32_t tail;
+  return forth_host_inline_length(cfa, most, &tail);
+}
+
+/* Code fields always hold their routine here, as without FORTH_DIRECT_THREADED. */
+extern "C" uint32_t forth_code_routine(uint32_t cfa) {
+  return *cell_at(cfa);
+}
+
+extern "C" uint32_t forth_code_field(uint32_t routine, uint32_t cfa) {
+  return routine;
+}
+
+/* Copies a colon word's body into the definition at HERE if it is INLINE or short enough, like _forth_inline_word. */
+static bool forth_host_inline_word(uint32_t cfa, uint32_t flags) {
+  if (forth_var_THREADING != THREADING_INDIRECT) return false;
+  uint32_t most = (flags & F_INLINE) ? 0xffffffff : forth_var_INLINE_SIZE * 4;
+  uint32_t tail;
+  uint32_t len = forth_host_inline_length(cfa, most, &tail);
+  if (len == 0xffffffff) return false;
+  if (tail != 0) len -= 4; // the call isn't in the body
+  for (uint32_t addr = cfa + 4; addr != cfa + 4 + len; addr += 4) {
+    forth_host_store_to_here(*cell_at(addr));
+  }
+  if (tail != 0) forth_host_store_to_here(tail); // (TAIL) <word> becomes a call to the word
+  // The body may end in a branch target, so nothing may fuse with it.
+  forth_peephole_here = 0;
+  return true;
+}
+
+/* Subroutine version of (CREATE). */
+static void forth_host_create(uint32_t buff_addr, uint32_t len) {
+  if (len > F_LENMASK) len = F_LENMASK;
+  uint32_t previous_latest = forth_var_LATEST;
+  uint32_t header = forth_var_HERE;
+  forth_var_LATEST = header;
+  cell_at(header)[0] = previous_latest;
+  *byte_at(header + 8) = len;
+  memmove(byte_at(header + 9), byte_at(buff_addr), len);
+  uint32_t end = header + 9 + len;
+  while (end & 3) *byte_at(end++) = 0;
+  cell_at(header)[1] = end;
+  forth_var_HERE = end;
+  forth_host_find_index_add(previous_latest);
+}
+
+/* Parses a name and creates a definition for it with the given code field, like _forth_define. */
+static void forth_host_define(uint32_t code) {
+  uint32_t len;
+  uint32_t buff_addr = forth_host_parse_name(&len);
+  forth_host_create(buff_addr, len);
+  forth_host_store_to_here(code);
+}
+
+/* Compiles LIT <x> into the definition at HERE, or LIT16 or LIT and x's halves for token threaded code. */
+static void forth_host_compile_literal(uint32_t x) {
+  if (forth_var_THREADING == THREADING_TOKEN) {
+    if ((int32_t)x == (int16_t)x) {
+      forth_host_store_halfword_to_here(TOKEN_LIT16);
+    } else {
+      forth_host_store_halfword_to_here(TOKEN_LIT);
+      forth_host_store_halfword_to_here(x);
+      x >>= 16;
+    }
+    forth_host_store_halfword_to_here(x);
+    return;
+  }
+  // Count the literals in a row, for forth_host_fold.
+  if (forth_peephole_here == forth_var_HERE && *cell_at(forth_peephole_last) == addr_of(&forth_lit)) {
+    forth_peephole_literals++;
+  } else {
+    forth_peephole_literals = 1;
+  }
+  forth_host_store_to_here(addr_of(&forth_lit));
+  forth_host_store_to_here(x);
+  forth_host_peephole_mark(forth_var_HERE - 8);
+}
+
+#ifdef FORTH_PROFILE
+/* A profile record and frame, laid out like in forth_system.S. */
+struct ProfileRecord {
+  uint32_t cfa;
+  uint32_t calls;
+  uint64_t inclusive;
+  uint64_t exclusive;
+};
+
+struct ProfileFrame {
+  uint32_t record; // 0 if there was no room for one
+  uint32_t start;
+  uint32_t callees;
+};
+
+/* Finds the profile record for a word, adding one if it's new, like _forth_profile_record. */
+static ProfileRecord *forth_host_profile_record(uint32_t cfa) {
+  uint32_t *buckets = &forth_profile_buckets;
+  uint32_t bucket = ((cfa ^ (cfa >> PROFILE_BUCKET_BITS)) >> 2) & (PROFILE_BUCKETS - 1);
+  for (; buckets[bucket] != 0; bucket = (bucket + 1) & (PROFILE_BUCKETS - 1)) {
+    ProfileRecord *record = (ProfileRecord *)cell_at(buckets[bucket]);
+    if (record->cfa == cfa) return record;
+  }
+  if (forth_profile_count == PROFILE_RECORDS) return nullptr;
+  ProfileRecord *record = (ProfileRecord *)&forth_profile_records + forth_profile_count;
+  record->cfa = cfa; // the rest of the record was cleared by PROFILE-RESET
+  buckets[bucket] = addr_of(record);
+  (&forth_profile_order)[forth_profile_count++] = addr_of(record);
+  return record;
+}
+
+/* Counts a call to a colon word, and pushes a frame for it. */
+static void forth_host_profile_enter(uint32_t cfa) {
+  ProfileRecord *record = forth_host_profile_record(cfa);
+  if (record != nullptr) record->calls++;
+  uint32_t depth = forth_profile_depth++;
+  if (depth >= PROFILE_DEPTH || record == nullptr) forth_profile_dropped++;
+  if (depth >= PROFILE_DEPTH) return;
+  ProfileFrame *frame = (ProfileFrame *)&forth_profile_frames + depth;
+  frame->record = addr_of(record);
+  frame->callees = 0;
+  frame->start = ARM_DWT_CYCCNT;
+}
+
+/* Pops the frame of the colon word that is exiting, like _forth_profile_exit. */
+static void forth_host_profile_exit() {
+  uint32_t now = ARM_DWT_CYCCNT;
+  if (forth_profile_depth == 0) return; // no frame, say after PROFILE-RESET
+  uint32_t depth = --forth_profile_depth;
+  if (depth >= PROFILE_DEPTH) return;
+  ProfileFrame *frame = (ProfileFrame *)&forth_profile_frames + depth;
+  uint32_t cycles = now - frame->start;
+  if (frame->record != 0) {
+    ProfileRecord *record = (ProfileRecord *)cell_at(frame->record);
+    record->inclusive += cycles;
+    record->exclusive += cycles - frame->callees;
+  }
+  if (depth != 0) frame[-1].callees += cycles;
+}
+
+#ifdef FORTH_PROFILE_NEXT
+/* Counts a run of a native word, from NEXT. */
+static void forth_host_profile_count(uint32_t cfa) {
+  ProfileRecord *record = forth_host_profile_record(cfa);
+  if (record != nullptr) record->calls++;
+}
+#endif
+
+/* Prints an unsigned double-cell number in BASE, like _forth_emit_udouble. */
+static void forth_host_emit_udouble(uint64_t n) {
+  uint32_t base = forth_var_BASE;
+  char digits[64];
+  int len = 0;
+  do {
+    uint32_t digit = base == 0 ? 0 : n % base;
+    n = base == 0 ? 0 : n / base;
+    digits[len++] = digit < 10 ? '0' + digit : 'A' - 10 + digit;
+  } while (n != 0);
+  while (len != 0) forth_host_emit(digits[--len]);
+}
+
+/* Prints the name of a word, or its address if it has no name. */
+static void forth_host_emit_name(uint32_t cfa) {
+  for (uint32_t defn = forth_var_LATEST; defn != 0; defn = *cell_at(defn)) {
+    if (cell_at(defn)[1] != cfa) continue;
+    uint32_t len = *byte_at(defn + 8) & F_LENMASK;
+    for (uint32_t i = 0; i < len; i++) forth_host_emit(*byte_at(defn + 9 + i));
+    return;
+  }
+  forth_host_emit_udouble(cfa);
+}
+#endif
+
+/* Where forth_enter starts the return stack. */
+static uint32_t *forth_host_rsp = &_estack;
+
+static uint32_t *forth_host_run(uint32_t *param_stack, uint32_t const *forth_word,
+                                uint32_t *rsp, uint32_t const *exit_word);
+
+extern "C" uint32_t* forth_enter(uint32_t* param_stack, uint32_t const* forth_word) {
+  forth_task_current = addr_of(&forth_task_main); // C always comes in as the main task
+  return forth_host_run(param_stack, forth_word, forth_host_rsp, &forth_quit);
+}
+
+/*
+ * Interrupts. The pending flags are by exception number, like the
+ * vectors. SIGUSR1 is blocked while its handler runs, so Forth interrupts
+ * don't preempt each other here: one signal runs everything pending.
+ */
+static std::atomic<bool> forth_host_irq_pending[IRQ_VECTORS];
+static std::atomic<uint32_t> forth_host_irq_raised;
+static pthread_t forth_host_irq_thread;
+
+static void forth_host_irq_handler(int) {
+  for (uint32_t exc = 0; exc < IRQ_VECTORS; exc++) {
+    if (!forth_host_irq_pending[exc].exchange(false)) continue;
+    uint32_t word = (&forth_irq_words)[exc];
+    if (word == 0) continue;
+    uint32_t raised = forth_host_irq_raised.exchange(0);
+    if (raised != 0) {
+      uint32_t latency = ARM_DWT_CYCCNT - raised;
+      if (latency > forth_var_IRQ_LATENCY) forth_var_IRQ_LATENCY = latency;
+    }
+    forth_host_run(&forth_irq_data_stack + 1, cell_at(word), &forth_irq_return_stack_end,
+                   &forth_irq_return);
+  }
+}
+
+/* The first BIND-IRQ installs the handler, for the thread that ran it. */
+static void forth_host_bind_irq() {
+  static bool bound = false;
+  if (bound) return;
+  forth_host_irq_thread = pthread_self();
+  struct sigaction action = {};
+  action.sa_handler = forth_host_irq_handler;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  sigaction(SIGUSR1, &action, nullptr);
+  bound = true;
+}
+
+/*
+ * Pends an IRQ, from any thread, noting when for IRQ_LATENCY. From the
+ * thread that bound it, the handler has run by the time this returns.
+ */
+void forth_host_raise_irq(int32_t irq) {
+  uint32_t exc = irq + 16;
+  if (exc >= IRQ_VECTORS) return;
+  forth_host_irq_raised = ARM_DWT_CYCCNT;
+  forth_host_irq_pending[exc] = true;
+  pthread_kill(forth_host_irq_thread, SIGUSR1);
+}
+
+/*
+ * The Forth machine. The registers from forth_system.S are locals:
+ *   tos is the top of the parameter stack,
+ *   psp points just past the second item on the parameter stack,
+ *   ftos and fsp are the same for the float stack,
+ *   rsp is the return stack pointer,
+ *   ip is the instruction pointer, and
+ *   w is the code field address of the word being executed.
+ */
+#define PUSHTOS() (*psp++ = tos)
+#define POPTOS() (tos = *--psp)
+#define PUSH(x) do { uint32_t x_ = (x); PUSHTOS(); tos = x_; } while (0)
+#define FPUSHTOS() (*fsp++ = bits_of(ftos))
+#define FPOPTOS() (ftos = float_of(*--fsp))
+#define FPUSH(x) do { float x_ = (x); FPUSHTOS(); ftos = x_; } while (0)
+#define EXECUTE() goto *(void *)(uintptr_t)*cell_at(*w)
+#ifdef FORTH_COUNT_DISPATCH
+#define COUNT_DISPATCH() (forth_dispatch_count++)
+#else
+#define COUNT_DISPATCH() ((void)0)
+#endif
+#ifdef FORTH_PROFILE_NEXT
+#define PROFILE_NEXT() \
+  do { \
+    if (*cell_at(*ip) != addr_of(&forth_code_do_colon)) forth_host_profile_count(*ip); \
+  } while (0)
+#else
+#define PROFILE_NEXT() ((void)0)
+#endif
+#define NEXT do { COUNT_DISPATCH(); PROFILE_NEXT(); w = cell_at(*ip++); EXECUTE(); } while (0)
+
+/*
+ * Runs forth_word on the given stacks until it returns to exit_word:
+ * forth_quit for forth_enter, or forth_irq_return for an interrupt.
+ */
+static uint32_t *forth_host_run(uint32_t *param_stack, uint32_t const *forth_word,
+                                uint32_t *rsp, uint32_t const *exit_word) {
+  static bool ready = false;
+  if (!ready) {
+#define FILL_NATIVE(name, flags, label) forth_code_##label = addr_of(&&code_##label);
+#define FILL_NONE(...)
+    FORTH_HOST_DICTIONARY(FILL_NATIVE, FILL_NONE, FILL_NONE)
+    forth_code_do_colon = addr_of(&&do_colon);
+    forth_code_do_native = addr_of(&&do_native);
+    forth_code_do_const = addr_of(&&do_const);
+    forth_code_do_var = addr_of(&&do_var);
+    forth_code_do_value = addr_of(&&do_value);
+    forth_code_do_does = addr_of(&&do_does);
+    forth_code_do_tokens = addr_of(&&do_tokens);
+    forth_code_token_resume = addr_of(&&token_resume);
+    forth_code_irq_return = addr_of(&&irq_return);
+    ready = true;
+  }
+
+  uint32_t *psp = param_stack - 1;
+  uint32_t tos = *psp;
+  uint32_t *fsp = cell_at(forth_fsp);
+  float ftos = float_of(*fsp);
+  uint32_t *task;
+  uint32_t *ip;
+  uint32_t *w;
+  uint32_t x, y;
+
+  // Like on the board, the first thread is on the return stack:
+  // <addr of program> <exit_word>
+  *--rsp = addr_of(exit_word);
+  *--rsp = addr_of(forth_word);
+  ip = rsp;
+  NEXT;
+
+do_colon:
+  *--rsp = addr_of(ip);
+  ip = w + 1;
+#ifdef FORTH_PROFILE
+  forth_host_profile_enter(addr_of(w));
+#endif
+  NEXT;
+
+do_native:
+  fprintf(stderr, "The host build can't run natively compiled words.\n");
+  abort();
+
+do_const:
+  PUSH(w[1]);
+  NEXT;
+
+do_var:
+  PUSH(addr_of(w + 1));
+  NEXT;
+
+do_value:
+  PUSH(*cell_at(w[1]));
+  NEXT;
+
+do_does:
+  // w[0] is the stub after (DOES>), and the words after DOES> follow it.
+  *--rsp = addr_of(ip);
+  ip = cell_at(w[0]) + 1;
+  PUSH(addr_of(w + 1));
+#ifdef FORTH_PROFILE
+  forth_host_profile_enter(addr_of(w));
+#endif
+  NEXT;
+
+/*
+ * Token threaded code, as in forth_system.S. A word that isn't special
+ * runs with ip at forth_token_thread, so that its NEXT comes back to
+ * token_resume, and the next token is kept in forth_token_ip.
+ */
+do_tokens:
+  *--rsp = addr_of(ip);
+  *--rsp = forth_token_ip;
+  forth_token_ip = addr_of(w + 1);
+  goto token_next;
+
+token_resume:
+token_next:
+  x = *halfword_at(forth_token_ip);
+  forth_token_ip += 2;
+  if (x & TOKEN_RELATIVE) {
+    w = cell_at((forth_token_ip & ~3u) - ((x & ~TOKEN_RELATIVE) << 2));
+  } else if (x >= TOKEN_SPECIALS) {
+    w = cell_at((&forth_token_table)[x]);
+  } else {
+    switch (x) {
+      case TOKEN_EXIT:
+        forth_token_ip = *rsp++;
+        ip = cell_at(*rsp++);
+        NEXT;
+      case TOKEN_LIT:
+        PUSHTOS();
+        memcpy(&tos, halfword_at(forth_token_ip), 4);
+        forth_token_ip += 4;
+        goto token_next;
+      case TOKEN_LIT16:
+        PUSH((int16_t)*halfword_at(forth_token_ip));
+        forth_token_ip += 2;
+        goto token_next;
+      case TOKEN_CALL:
+        memcpy(&x, halfword_at(forth_token_ip), 4);
+        forth_token_ip += 4;
+        w = cell_at(x);
+        break;
+      case TOKEN_BRANCH:
+        x = (int16_t)*halfword_at(forth_token_ip);
+        forth_token_ip += 2 + 2 * x;
+        goto token_next;
+      case TOKEN_BRANCHEQ:
+        x = (int16_t)*halfword_at(forth_token_ip);
+        forth_token_ip += 2;
+        if (tos == 0) forth_token_ip += 2 * x;
+        POPTOS();
+        goto token_next;
+      case TOKEN_DO:
+        x = (int16_t)*halfword_at(forth_token_ip);
+        forth_token_ip += 2;
+        rsp -= 3;
+        rsp[2] = forth_token_ip + 2 * x;
+        rsp[1] = *--psp ^ 0x80000000;
+        rsp[0] = tos - rsp[1];
+        POPTOS();
+        goto token_next;
+      case TOKEN_MAYBE_DO:
+        x = (int16_t)*halfword_at(forth_token_ip);
+        forth_token_ip += 2;
+        y = *--psp;
+        if (tos == y) {
+          forth_token_ip += 2 * x;
+        } else {
+          rsp -= 3;
+          rsp[2] = forth_token_ip + 2 * x;
+          rsp[1] = y ^ 0x80000000;
+          rsp[0] = tos - rsp[1];
+        }
+        POPTOS();
+        goto token_next;
+      case TOKEN_LOOP:
+      case TOKEN_PLUS_LOOP:
+        y = x == TOKEN_LOOP ? 1 : tos;
+        if (x == TOKEN_PLUS_LOOP) POPTOS();
+        x = (int16_t)*halfword_at(forth_token_ip);
+        forth_token_ip += 2;
+        if (__builtin_add_overflow((int32_t)rsp[0], (int32_t)y, (int32_t *)&rsp[0])) {
+          rsp += 3;
+        } else {
+          forth_token_ip += 2 * x;
+        }
+        goto token_next;
+      case TOKEN_LEAVE:
+        forth_token_ip = rsp[2];
+        rsp += 3;
+        goto token_next;
+    }
+  }
+  ip = &forth_token_thread;
+  EXECUTE();
+
+code_quit:
+#ifdef FORTH_PROFILE
+  forth_profile_depth = 0; // any frames left are abandoned
+#endif
+  // tos goes back into memory, into the cell under the bottom if the stack is empty.
+  *psp = tos;
+  *fsp = bits_of(ftos); // where the next push would put it
+  forth_fsp = addr_of(fsp);
+  return psp + 1;
+
+irq_return:
+  return psp;
+
+code_exit:
+#ifdef FORTH_PROFILE
+  forth_host_profile_exit();
+#endif
+  ip = cell_at(*rsp++);
+  NEXT;
+
+code_lit:
+  PUSH(*ip++);
+  NEXT;
+
+code_drop:
+  POPTOS();
+  NEXT;
+
+code_2drop:
+  psp -= 2;
+  tos = *psp;
+  NEXT;
+
+code_swap:
+  x = psp[-1];
+  psp[-1] = tos;
+  tos = x;
+  NEXT;
+
+code_2swap:
+  x = psp[-3];
+  y = psp[-2];
+  psp[-3] = psp[-1];
+  psp[-2] = tos;
+  psp[-1] = x;
+  tos = y;
+  NEXT;
+
+code_dup:
+  PUSHTOS();
+  NEXT;
+
+code_2dup:
+  x = psp[-1];
+  psp[0] = tos;
+  psp[1] = x;
+  psp += 2;
+  NEXT;
+
+code_maybe_dup:
+  if (tos != 0) PUSHTOS();
+  NEXT;
+
+code_over:
+  PUSH(psp[-1]);
+  NEXT;
+
+code_rot:
+  x = psp[-2];
+  psp[-2] = psp[-1];
+  psp[-1] = tos;
+  tos = x;
+  NEXT;
+
+code_nrot:
+  x = psp[-1];
+  psp[-1] = psp[-2];
+  psp[-2] = tos;
+  tos = x;
+  NEXT;
+
+code_inc:
+  tos += 1;
+  NEXT;
+
+code_dec:
+  tos -= 1;
+  NEXT;
+
+code_inc4:
+  tos += 4;
+  NEXT;
+
+code_dec4:
+  tos -= 4;
+  NEXT;
+
+code_add:
+  tos = *--psp + tos;
+  NEXT;
+
+code_sub:
+  tos = *--psp - tos;
+  NEXT;
+
+code_mul:
+  tos = *--psp * tos;
+  NEXT;
+
+code_divmod:
+  x = psp[-1];
+  y = forth_sdiv(x, tos);
+  psp[-1] = x - y * tos;
+  tos = y;
+  NEXT;
+
+code_div:
+  tos = forth_sdiv(*--psp, tos);
+  NEXT;
+
+code_umul: {
+  uint64_t d = (uint64_t)psp[-1] * tos;
+  psp[-1] = (uint32_t)d;
+  tos = (uint32_t)(d >> 32);
+  NEXT;
+}
+
+code_mmul: {
+  int64_t d = (int64_t)(int32_t)psp[-1] * (int32_t)tos;
+  psp[-1] = (uint32_t)d;
+  tos = (uint32_t)((uint64_t)d >> 32);
+  NEXT;
+}
+
+code_um_divmod:
+  forth_host_um_divmod((uint64_t)psp[-1] << 32 | psp[-2], tos, &x, &y);
+  goto divmod_done;
+
+code_sm_divrem:
+  forth_host_sm_divmod((uint64_t)psp[-1] << 32 | psp[-2], tos, &x, &y);
+  goto divmod_done;
+
+code_fm_divmod:
+  forth_host_sm_divmod((uint64_t)psp[-1] << 32 | psp[-2], tos, &x, &y);
+  if (y != 0 && (int32_t)(y ^ tos) < 0) { // the remainder's sign isn't the divisor's
+    x--;
+    y += tos;
+  }
+divmod_done:
+  // ( d n -- rem quot )
+  psp--;
+  psp[-1] = y;
+  tos = x;
+  NEXT;
+
+code_star_slash:
+  // ( n1 n2 n3 -- n4 )
+  psp -= 2;
+  forth_host_sm_divmod((uint64_t)((int64_t)(int32_t)psp[0] * (int32_t)psp[1]), tos, &tos, &y);
+  NEXT;
+
+code_star_slash_mod:
+  forth_host_sm_divmod((uint64_t)((int64_t)(int32_t)psp[-2] * (int32_t)psp[-1]), tos, &x, &y);
+  goto divmod_done;
+
+code_dadd: {
+  // ( d1 d2 -- d1+d2 )
+  uint64_t d = ((uint64_t)psp[-2] << 32 | psp[-3]) + ((uint64_t)tos << 32 | psp[-1]);
+  psp -= 2;
+  psp[-1] = (uint32_t)d;
+  tos = (uint32_t)(d >> 32);
+  NEXT;
+}
+
+code_dsub: {
+  uint64_t d = ((uint64_t)psp[-2] << 32 | psp[-3]) - ((uint64_t)tos << 32 | psp[-1]);
+  psp -= 2;
+  psp[-1] = (uint32_t)d;
+  tos = (uint32_t)(d >> 32);
+  NEXT;
+}
+
+code_dnegate: {
+  uint64_t d = 0 - ((uint64_t)tos << 32 | psp[-1]);
+  psp[-1] = (uint32_t)d;
+  tos = (uint32_t)(d >> 32);
+  NEXT;
+}
+
+code_dlt:
+  psp -= 3;
+  tos = (int64_t)((uint64_t)psp[1] << 32 | psp[0]) < (int64_t)((uint64_t)tos << 32 | psp[2])
+      ? 0xffffffff : 0;
+  NEXT;
+
+code_eq:
+  tos = *--psp == tos ? 0xffffffff : 0;
+  NEXT;
+
+code_ne:
+  tos = *--psp != tos ? 0xffffffff : 0;
+  NEXT;
+
+code_lt:
+  tos = (int32_t)*--psp < (int32_t)tos ? 0xffffffff : 0;
+  NEXT;
+
+code_gt:
+  tos = (int32_t)*--psp > (int32_t)tos ? 0xffffffff : 0;
+  NEXT;
+
+code_le:
+  tos = (int32_t)*--psp <= (int32_t)tos ? 0xffffffff : 0;
+  NEXT;
+
+code_ge:
+  tos = (int32_t)*--psp >= (int32_t)tos ? 0xffffffff : 0;
+  NEXT;
+
+code_eqz:
+  tos = tos == 0 ? 0xffffffff : 0;
+  NEXT;
+
+code_nez:
+  tos = tos != 0 ? 0xffffffff : 0;
+  NEXT;
+
+code_ltz:
+  tos = (int32_t)tos < 0 ? 0xffffffff : 0;
+  NEXT;
+
+code_gtz:
+  tos = (int32_t)tos > 0 ? 0xffffffff : 0;
+  NEXT;
+
+code_lez:
+  tos = (int32_t)tos <= 0 ? 0xffffffff : 0;
+  NEXT;
+
+code_gez:
+  tos = (int32_t)tos >= 0 ? 0xffffffff : 0;
+  NEXT;
+
+code_and:
+  tos &= *--psp;
+  NEXT;
+
+code_or:
+  tos |= *--psp;
+  NEXT;
+
+code_xor:
+  tos ^= *--psp;
+  NEXT;
+
+code_not:
+  tos = ~tos;
+  NEXT;
+
+code_lshift:
+  tos = forth_host_lshift(*--psp, tos);
+  NEXT;
+
+code_rshift:
+  tos = forth_host_rshift(*--psp, tos);
+  NEXT;
+
+code_store:
+  *cell_at(tos) = psp[-1];
+  psp -= 2;
+  tos = *psp;
+  NEXT;
+
+code_store_char:
+  *byte_at(tos) = psp[-1];
+  psp -= 2;
+  tos = *psp;
+  NEXT;
+
+code_fetch:
+  tos = *cell_at(tos);
+  NEXT;
+
+code_fetch_char:
+  tos = *byte_at(tos);
+  NEXT;
+
+code_addstore:
+  *cell_at(tos) += psp[-1];
+  psp -= 2;
+  tos = *psp;
+  NEXT;
+
+code_substore:
+  *cell_at(tos) -= psp[-1];
+  psp -= 2;
+  tos = *psp;
+  NEXT;
+
+code_memcpy:
+  // ( src-addr dest-addr len -- )
+  memcpy(byte_at(psp[-1]), byte_at(psp[-2]), tos);
+  psp -= 3;
+  tos = *psp;
+  NEXT;
+
+code_memmove:
+  memmove(byte_at(psp[-1]), byte_at(psp[-2]), tos);
+  psp -= 3;
+  tos = *psp;
+  NEXT;
+
+code_param_to_return:
+  *--rsp = tos;
+  POPTOS();
+  NEXT;
+
+code_return_to_param:
+  PUSH(*rsp++);
+  NEXT;
+
+code_fetch_return:
+  PUSH(*rsp);
+  NEXT;
+
+code_store_return:
+  *rsp = tos;
+  POPTOS();
+  NEXT;
+
+code_source:
+  PUSH(forth_var_STDIN != 0 ? forth_var_STDIN : addr_of(&forth_tib));
+  PUSH(forth_var_STDIN != 0 ? forth_var_STDIN_COUNT : forth_source_tib_count);
+  NEXT;
+
+code_to_in:
+  PUSH(addr_of(&forth_source_in));
+  NEXT;
+
+code_refill:
+  PUSH(forth_host_refill());
+  NEXT;
+
+code_key:
+  PUSH(forth_host_key());
+  NEXT;
+
+code_accept:
+  x = tos;
+  POPTOS();
+  tos = forth_host_accept(tos, x);
+  NEXT;
+
+code_emit:
+  forth_host_emit(tos);
+  POPTOS();
+  NEXT;
+
+code_type:
+  x = tos;
+  POPTOS();
+  forth_host_type(byte_at(tos), x);
+  POPTOS();
+  NEXT;
+
+code_flush:
+  forth_flush_output();
+  NEXT;
+
+code_flush_on_newline:
+  forth_var_FLUSH_POLICY = FLUSH_ON_NEWLINE;
+  NEXT;
+
+code_flush_on_idle:
+  forth_var_FLUSH_POLICY = FLUSH_ON_IDLE;
+  NEXT;
+
+code_flush_when_full:
+  forth_var_FLUSH_POLICY = FLUSH_WHEN_FULL;
+  NEXT;
+
+code_word:
+  x = forth_host_word();
+  PUSH(addr_of(&forth_word_buffer));
+  PUSH(x);
+  NEXT;
+
+code_parse_name:
+  x = forth_host_parse_name(&y);
+  PUSH(x);
+  PUSH(y);
+  NEXT;
+
+code_number: {
+  bool is_double;
+  psp[-1] = (uint32_t)forth_host_number(psp[-1], tos, &tos, &is_double);
+  NEXT;
+}
+
+code_find:
+  x = *--psp;
+  tos = forth_host_find(x, tos);
+  NEXT;
+
+code_to_code_field_addr:
+  tos = cell_at(tos)[1];
+  NEXT;
+
+code_to_data_field_addr:
+  tos = cell_at(tos)[1] + 4;
+  NEXT;
+
+code_create:
+  // ( buff-addr len -- )
+  forth_host_create(psp[-1], tos);
+  psp -= 2;
+  tos = *psp;
+  NEXT;
+
+code_store_to_here:
+  forth_host_store_to_here(tos);
+  POPTOS();
+  NEXT;
+
+code_lit_add:
+  tos += *ip++;
+  NEXT;
+
+code_dup_brancheq:
+  x = *ip++;
+  if (tos == 0) ip += (int32_t)x;
+  NEXT;
+
+code_nip:
+  psp--;
+  NEXT;
+
+code_fetch_add:
+  x = *cell_at(tos);
+  POPTOS();
+  tos += x;
+  NEXT;
+
+code_immediate_mode:
+  forth_var_STATE = 0;
+  NEXT;
+
+code_compile_mode:
+  forth_var_STATE = 1;
+  NEXT;
+
+code_toggle_hidden:
+  *forth_host_flags(tos) ^= F_HIDDEN;
+  POPTOS();
+  NEXT;
+
+code_toggle_immediate:
+  *forth_host_flags(forth_var_LATEST) ^= F_IMMED;
+  NEXT;
+
+code_toggle_inline:
+  *forth_host_flags(forth_var_LATEST) ^= F_INLINE;
+  NEXT;
+
+code_branch:
+  x = *ip++;
+  ip += (int32_t)x;
+  NEXT;
+
+code_brancheq:
+  x = *ip++;
+  if (tos == 0) ip += (int32_t)x;
+  POPTOS();
+  NEXT;
+
+/*
+ * A loop frame is rsp[0] = index-limit+0x80000000, rsp[1] =
+ * limit-0x80000000 and rsp[2] = where to LEAVE to, as in forth_system.S.
+ */
+code_mark_forward:
+  PUSH(forth_host_mark_forward());
+  NEXT;
+
+code_resolve_forward:
+  forth_host_resolve_forward(tos);
+  POPTOS();
+  NEXT;
+
+code_resolve_backward:
+  forth_host_resolve_backward(tos);
+  POPTOS();
+  NEXT;
+
+code_paren_do:
+  x = *ip++;
+  rsp -= 3;
+  rsp[2] = addr_of(ip + (int32_t)x);
+  rsp[1] = *--psp ^ 0x80000000;
+  rsp[0] = tos - rsp[1];
+  POPTOS();
+  NEXT;
+
+code_paren_maybe_do:
+  x = *ip++;
+  y = *--psp;
+  if (tos == y) {
+    ip += (int32_t)x;
+  } else {
+    rsp -= 3;
+    rsp[2] = addr_of(ip + (int32_t)x);
+    rsp[1] = y ^ 0x80000000;
+    rsp[0] = tos - rsp[1];
+  }
+  POPTOS();
+  NEXT;
+
+code_paren_loop:
+  x = *ip++;
+  if (__builtin_add_overflow((int32_t)rsp[0], 1, (int32_t *)&rsp[0])) {
+    rsp += 3;
+  } else {
+    ip += (int32_t)x;
+  }
+  NEXT;
+
+code_paren_plus_loop:
+  x = *ip++;
+  if (__builtin_add_overflow((int32_t)rsp[0], (int32_t)tos, (int32_t *)&rsp[0])) {
+    rsp += 3;
+  } else {
+    ip += (int32_t)x;
+  }
+  POPTOS();
+  NEXT;
+
+code_i:
+  PUSH(rsp[0] + rsp[1]);
+  NEXT;
+
+code_j:
+  PUSH(rsp[3] + rsp[4]);
+  NEXT;
+
+code_leave:
+  ip = cell_at(rsp[2]);
+  rsp += 3;
+  NEXT;
+
+code_unloop:
+  rsp += 3;
+  NEXT;
+
+code_do:
+  PUSH(forth_host_compile_do(addr_of(&forth_paren_do)));
+  NEXT;
+
+code_maybe_do:
+  PUSH(forth_host_compile_do(addr_of(&forth_paren_maybe_do)));
+  NEXT;
+
+code_loop:
+  forth_host_compile_loop(addr_of(&forth_paren_loop), tos);
+  POPTOS();
+  NEXT;
+
+code_plus_loop:
+  forth_host_compile_loop(addr_of(&forth_paren_plus_loop), tos);
+  POPTOS();
+  NEXT;
+
+code_char:
+  PUSH(*byte_at(forth_host_parse_name(&x)));
+  NEXT;
+
+code_char_newline:
+  PUSH(10);
+  NEXT;
+
+code_emit_newline:
+  forth_host_emit(10);
+  NEXT;
+
+code_cr:
+  forth_host_emit(10);
+  NEXT;
+
+code_char_space:
+  PUSH(' ');
+  NEXT;
+
+code_emit_space:
+  forth_host_emit(' ');
+  NEXT;
+
+code_threaded_mode:
+  forth_var_THREADING = THREADING_INDIRECT;
+  NEXT;
+
+code_native_mode:
+  forth_var_THREADING = THREADING_NATIVE;
+  NEXT;
+
+code_token_mode:
+  forth_var_THREADING = THREADING_TOKEN;
+  NEXT;
+
+code_prologue:
+  if (forth_var_THREADING == THREADING_TOKEN) {
+    forth_host_store_to_here(addr_of(&forth_do_tokens));
+  } else {
+    forth_host_store_to_here(addr_of(&forth_do_colon));
+  }
+  NEXT;
+
+code_epilogue:
+  if (forth_host_tail_call_last()) NEXT;
+  forth_host_compile_word(addr_of(&forth_exit));
+  if (forth_var_HERE & 2) forth_host_store_halfword_to_here(TOKEN_EXIT); // keeps HERE aligned
+  NEXT;
+
+code_paren_tail:
+  ip = cell_at(*ip) + 1;
+  NEXT;
+
+code_tail_calls_on:
+  forth_var_TAIL_CALLS = 1;
+  NEXT;
+
+code_tail_calls_off:
+  forth_var_TAIL_CALLS = 0;
+  NEXT;
+
+code_tail_call_comma:
+  forth_host_compile_tail_call(tos);
+  POPTOS();
+  NEXT;
+
+code_compile_comma:
+  forth_host_compile_word(tos);
+  POPTOS();
+  NEXT;
+
+code_create_named:
+  forth_host_define(addr_of(&forth_do_var));
+  NEXT;
+
+code_variable:
+  forth_host_define(addr_of(&forth_do_var));
+  forth_host_store_to_here(0);
+  NEXT;
+
+code_constant:
+  forth_host_define(addr_of(&forth_do_const));
+  forth_host_store_to_here(tos);
+  POPTOS();
+  NEXT;
+
+code_value:
+  forth_host_define(addr_of(&forth_do_value));
+  forth_host_store_to_here(forth_var_HERE + 4);
+  forth_host_store_to_here(tos);
+  POPTOS();
+  NEXT;
+
+code_to: {
+  // ( x "name" -- ) Does nothing if name isn't a VALUE.
+  uint32_t len;
+  uint32_t buff_addr = forth_host_parse_name(&len);
+  uint32_t defn = forth_host_find(buff_addr, len);
+  if (defn == 0) NEXT;
+  uint32_t *cfa = cell_at(cell_at(defn)[1]);
+  if (cfa[0] != addr_of(&forth_do_value)) NEXT;
+  if (forth_var_STATE != 0) {
+    forth_host_compile_literal(cfa[1]);
+    forth_host_compile_word(addr_of(&forth_store));
+  } else {
+    *cell_at(cfa[1]) = tos;
+    POPTOS();
+  }
+  NEXT;
+}
+
+code_paren_does:
+  // The stub after the 0 holds do_does, so it serves as a code slot.
+  *cell_at(cell_at(forth_var_LATEST)[1]) = addr_of(ip + 1);
+  goto code_exit;
+
+code_does:
+  forth_host_store_to_here(addr_of(&forth_paren_does));
+  forth_host_store_to_here(0); // the stub's inline length, as on the board
+  forth_host_store_to_here(forth_code_do_does);
+  NEXT;
+
+code_literal:
+  forth_host_compile_literal(tos);
+  POPTOS();
+  NEXT;
+
+code_interpret: {
+  uint32_t len;
+  uint32_t buff_addr = forth_host_parse_name(&len);
+  uint32_t defn = forth_host_find(buff_addr, len);
+  if (defn != 0) {
+    if ((forth_host_load_flags(defn) & F_IMMED) || forth_var_STATE == 0) {
+      // An immediate word may mark HERE as a branch target, so
+      // don't let the next word fuse across it. ; still needs to
+      // know whether it's the first immediate word since the last
+      // word was compiled, for tail calls.
+      forth_peephole_immediate_here = forth_peephole_here;
+      forth_peephole_here = 0;
+      w = cell_at(cell_at(defn)[1]);
+      EXECUTE();
+    }
+    if (!forth_host_inline_word(cell_at(defn)[1], forth_host_load_flags(defn))) {
+      forth_host_compile_word(cell_at(defn)[1]);
+    }
+    NEXT;
+  }
+
+  uint32_t left;
+  bool is_double;
+  uint64_t number = forth_host_number(buff_addr, len, &left, &is_double);
+  x = (uint32_t)number;
+  float f;
+  if (left != 0 && forth_host_float(buff_addr, len, &f)) {
+    if (forth_var_STATE != 0) {
+      forth_host_compile_literal(bits_of(f));
+      forth_host_compile_word(addr_of(&forth_paren_fliteral));
+    } else {
+      FPUSH(f);
+    }
+  } else if (left != 0) {
+    PUSH(x);
+    PUSH(left);
+  } else if (is_double) {
+    if (forth_var_STATE != 0) {
+      forth_host_compile_literal(x);
+      forth_host_compile_literal((uint32_t)(number >> 32));
+    } else {
+      PUSH(x);
+      PUSH((uint32_t)(number >> 32));
+    }
+  } else if (forth_var_STATE != 0) {
+    forth_host_compile_literal(x);
+  } else {
+    PUSH(x);
+  }
+  NEXT;
+}
+
+code_pause:
+  task = cell_at(forth_task_current);
+  for (w = cell_at(task[TASK_LINK]); w != task; w = cell_at(w[TASK_LINK])) {
+    if (w[TASK_AWAKE] != 0) break;
+  }
+  if (w == task) NEXT; // no other task is awake
+  PUSHTOS();
+  task[TASK_PSP] = addr_of(psp);
+  task[TASK_IP] = addr_of(ip);
+  task[TASK_RSP] = addr_of(rsp);
+  task[TASK_TOKEN_IP] = forth_token_ip;
+  task[TASK_BASE] = forth_var_BASE;
+  task[TASK_STATE] = forth_var_STATE;
+  task[TASK_FTOS] = bits_of(ftos);
+  task[TASK_FSP] = addr_of(fsp);
+  forth_task_current = addr_of(w);
+  psp = cell_at(w[TASK_PSP]);
+  ip = cell_at(w[TASK_IP]);
+  rsp = cell_at(w[TASK_RSP]);
+  forth_token_ip = w[TASK_TOKEN_IP];
+  forth_var_BASE = w[TASK_BASE];
+  forth_var_STATE = w[TASK_STATE];
+  ftos = float_of(w[TASK_FTOS]);
+  fsp = cell_at(w[TASK_FSP]);
+  POPTOS();
+  NEXT;
+
+code_task:
+  forth_host_define(addr_of(&forth_do_var));
+  task = cell_at(forth_var_HERE);
+  x = tos; // return cells
+  POPTOS();
+  y = tos; // data cells
+  POPTOS();
+  task[TASK_S0] = addr_of(task) + TASK_SIZE;
+  task[TASK_F0] = task[TASK_S0] + 4 + 4 * y;
+  task[TASK_R0] = (task[TASK_F0] + 4 * (TASK_FLOAT_CELLS + 1) + 4 * x + 7) & ~7u;
+  forth_var_HERE = task[TASK_R0];
+  task[TASK_AWAKE] = 0;
+  task[TASK_THREAD + 1] = addr_of(&forth_lit);
+  task[TASK_THREAD + 2] = addr_of(task);
+  task[TASK_THREAD + 3] = addr_of(&forth_stop);
+  task[TASK_LINK] = (&forth_task_main)[TASK_LINK];
+  (&forth_task_main)[TASK_LINK] = addr_of(task);
+  NEXT;
+
+code_start:
+  task = cell_at(tos);
+  POPTOS();
+  task[TASK_THREAD] = tos;
+  POPTOS();
+  task[TASK_IP] = addr_of(&task[TASK_THREAD]);
+  task[TASK_PSP] = task[TASK_S0] + 4;
+  task[TASK_RSP] = task[TASK_R0];
+  task[TASK_FSP] = task[TASK_F0];
+  task[TASK_FTOS] = 0;
+  task[TASK_TOKEN_IP] = 0;
+  task[TASK_BASE] = forth_var_BASE;
+  task[TASK_STATE] = 0;
+  task[TASK_AWAKE] = 1;
+  NEXT;
+
+code_stop:
+  task = cell_at(tos);
+  POPTOS();
+  task[TASK_AWAKE] = 0;
+  if (addr_of(task) != forth_task_current) NEXT;
+  for (w = cell_at(task[TASK_LINK]); w != task; w = cell_at(w[TASK_LINK])) {
+    if (w[TASK_AWAKE] != 0) break;
+  }
+  if (w == task) (&forth_task_main)[TASK_AWAKE] = 1; // no other task is awake
+  goto code_pause;
+
+code_fadd:
+  y = *--fsp;
+  ftos = float_of(y) + ftos;
+  NEXT;
+
+code_fsub:
+  y = *--fsp;
+  ftos = float_of(y) - ftos;
+  NEXT;
+
+code_fmul:
+  y = *--fsp;
+  ftos = float_of(y) * ftos;
+  NEXT;
+
+code_fdiv:
+  y = *--fsp;
+  ftos = float_of(y) / ftos;
+  NEXT;
+
+code_fsqrt:
+  ftos = sqrtf(ftos);
+  NEXT;
+
+code_fnegate:
+  ftos = -ftos;
+  NEXT;
+
+code_fabs:
+  ftos = fabsf(ftos);
+  NEXT;
+
+code_fdup:
+  FPUSHTOS();
+  NEXT;
+
+code_fdrop:
+  FPOPTOS();
+  NEXT;
+
+code_fswap:
+  y = fsp[-1];
+  fsp[-1] = bits_of(ftos);
+  ftos = float_of(y);
+  NEXT;
+
+code_fover:
+  FPUSH(float_of(fsp[-1]));
+  NEXT;
+
+code_ffetch:
+  FPUSH(float_of(*cell_at(tos)));
+  POPTOS();
+  NEXT;
+
+code_fstore:
+  *cell_at(tos) = bits_of(ftos);
+  FPOPTOS();
+  POPTOS();
+  NEXT;
+
+code_f_to_s:
+  PUSH(forth_f32_to_s32(ftos));
+  FPOPTOS();
+  NEXT;
+
+code_s_to_f:
+  FPUSH((float)(int32_t)tos);
+  POPTOS();
+  NEXT;
+
+code_flt:
+  y = *--fsp;
+  PUSH(float_of(y) < ftos ? ~0u : 0);
+  FPOPTOS();
+  NEXT;
+
+code_fltz:
+  PUSH(ftos < 0 ? ~0u : 0);
+  FPOPTOS();
+  NEXT;
+
+code_feqz:
+  PUSH(ftos == 0 ? ~0u : 0);
+  FPOPTOS();
+  NEXT;
+
+code_paren_fliteral:
+  FPUSH(float_of(tos));
+  POPTOS();
+  NEXT;
+
+code_fliteral:
+  forth_host_compile_literal(bits_of(ftos));
+  FPOPTOS();
+  forth_host_compile_word(addr_of(&forth_paren_fliteral));
+  NEXT;
+
+code_vadd:
+  // ( src1 src2 dst count -- )
+  forth_host_vector(psp[-3], psp[-2], psp[-1], tos, 4, forth_host_vadd);
+  goto vector_done;
+
+code_vsub:
+  forth_host_vector(psp[-3], psp[-2], psp[-1], tos, 4, forth_host_vsub);
+  goto vector_done;
+
+code_vmul:
+  forth_host_vector(psp[-3], psp[-2], psp[-1], tos, 4, forth_host_vmul);
+  goto vector_done;
+
+code_vhadd:
+  forth_host_vector(psp[-3], psp[-2], psp[-1], tos, 2, forth_host_vadd);
+  goto vector_done;
+
+code_vhsub:
+  forth_host_vector(psp[-3], psp[-2], psp[-1], tos, 2, forth_host_vsub);
+  goto vector_done;
+
+code_vhmul:
+  forth_host_vector(psp[-3], psp[-2], psp[-1], tos, 2, forth_host_vmul);
+  goto vector_done;
+
+code_vhadd_sat:
+  forth_host_vector(psp[-3], psp[-2], psp[-1], tos, 2, forth_host_vqadd16);
+  goto vector_done;
+
+code_vcadd:
+  forth_host_vector(psp[-3], psp[-2], psp[-1], tos, 1, forth_host_vadd);
+  goto vector_done;
+
+code_vcsub:
+  forth_host_vector(psp[-3], psp[-2], psp[-1], tos, 1, forth_host_vsub);
+  goto vector_done;
+
+code_vcmul:
+  forth_host_vector(psp[-3], psp[-2], psp[-1], tos, 1, forth_host_vmul);
+  goto vector_done;
+
+code_vcadd_sat:
+  forth_host_vector(psp[-3], psp[-2], psp[-1], tos, 1, forth_host_vqadd8);
+vector_done:
+  psp -= 4;
+  tos = *psp;
+  NEXT;
+
+code_vhdot: {
+  // ( src1 src2 count -- n )
+  x = psp[-2];
+  y = psp[-1];
+  psp -= 2;
+  uint32_t n = 0;
+  for (; tos; tos--, x += 2, y += 2)
+    n += (uint32_t)(forth_host_element(x, 2) * forth_host_element(y, 2));
+  tos = n;
+  NEXT;
+}
+
+code_vhmac: {
+  // ( d1 src1 src2 count -- d2 )
+  uint64_t d = (uint64_t)psp[-3] << 32 | psp[-4];
+  x = psp[-2];
+  y = psp[-1];
+  for (; tos; tos--, x += 2, y += 2)
+    d += (uint64_t)(int64_t)(forth_host_element(x, 2) * forth_host_element(y, 2));
+  psp -= 3;
+  psp[-1] = (uint32_t)d;
+  tos = (uint32_t)(d >> 32);
+  NEXT;
+}
+
+code_vcsad: {
+  // ( src1 src2 count -- u )
+  x = psp[-2];
+  y = psp[-1];
+  psp -= 2;
+  uint32_t n = 0;
+  for (; tos; tos--, x++, y++)
+    n += (uint32_t)abs(*byte_at(x) - *byte_at(y));
+  tos = n;
+  NEXT;
+}
+
+code_vsum: {
+  // ( src count -- n )
+  x = *--psp;
+  uint32_t n = 0;
+  for (; tos; tos--, x += 4) n += *cell_at(x);
+  tos = n;
+  NEXT;
+}
+
+code_vmin: {
+  x = *--psp;
+  uint32_t n = INT32_MAX;
+  for (; tos; tos--, x += 4)
+    if ((int32_t)*cell_at(x) < (int32_t)n) n = *cell_at(x);
+  tos = n;
+  NEXT;
+}
+
+code_vmax: {
+  x = *--psp;
+  uint32_t n = (uint32_t)INT32_MIN;
+  for (; tos; tos--, x += 4)
+    if ((int32_t)*cell_at(x) > (int32_t)n) n = *cell_at(x);
+  tos = n;
+  NEXT;
+}
+
+code_vhsum: {
+  x = *--psp;
+  uint32_t n = 0;
+  for (; tos; tos--, x += 2) n += (uint32_t)forth_host_element(x, 2);
+  tos = n;
+  NEXT;
+}
+
+code_vhmin: {
+  x = *--psp;
+  uint32_t n = INT16_MAX;
+  for (; tos; tos--, x += 2)
+    if (forth_host_element(x, 2) < (int32_t)n) n = (uint32_t)forth_host_element(x, 2);
+  tos = n;
+  NEXT;
+}
+
+code_vhmax: {
+  x = *--psp;
+  uint32_t n = (uint32_t)INT16_MIN;
+  for (; tos; tos--, x += 2)
+    if (forth_host_element(x, 2) > (int32_t)n) n = (uint32_t)forth_host_element(x, 2);
+  tos = n;
+  NEXT;
+}
+
+code_bind_irq:
+  x = tos + 16; // the exception number
+  POPTOS();
+  if (x < IRQ_VECTORS) {
+    (&forth_irq_words)[x] = tos;
+    forth_host_bind_irq();
+  }
+  POPTOS();
+  NEXT;
+
+code_trigger_irq:
+  x = tos;
+  POPTOS();
+  forth_host_raise_irq(x);
+  NEXT;
+
+#ifdef FORTH_PROFILE
+code_profile_reset:
+  memset(&forth_profile_records, 0, sizeof(ProfileRecord) * PROFILE_RECORDS);
+  memset(&forth_profile_buckets, 0, 4 * PROFILE_BUCKETS);
+  memset(&forth_profile_order, 0, 4 * PROFILE_RECORDS);
+  forth_profile_count = 0;
+  forth_profile_depth = 0; // frames still running are abandoned
+  forth_profile_dropped = 0;
+  NEXT;
+
+code_profile_sort: {
+  // An insertion sort, so that ties stay in the order they ran.
+  uint32_t *order = &forth_profile_order;
+  for (uint32_t i = 1; i < forth_profile_count; i++) {
+    uint32_t record = order[i];
+    uint64_t exclusive = ((ProfileRecord *)cell_at(record))->exclusive;
+    uint32_t j = i;
+    for (; j != 0 && ((ProfileRecord *)cell_at(order[j - 1]))->exclusive < exclusive; j--) {
+      order[j] = order[j - 1];
+    }
+    order[j] = record;
+  }
+  NEXT;
+}
+
+code_profile_dump:
+  for (uint32_t i = 0; i < forth_profile_count; i++) {
+    ProfileRecord *record = (ProfileRecord *)cell_at((&forth_profile_order)[i]);
+    forth_host_emit_name(record->cfa);
+    forth_host_emit(' ');
+    forth_host_emit_udouble(record->calls);
+    forth_host_emit(' ');
+    forth_host_emit_udouble(record->inclusive);
+    forth_host_emit(' ');
+    forth_host_emit_udouble(record->exclusive);
+    forth_host_emit(10);
+  }
+  NEXT;
+#endif
+}
+
+/*
+ * Writing the bootstrap image. Builtins are at different addresses on the
+ * host and on the board, so the image is written as assembly that names
+ * them: a cell holding a builtin's address becomes its symbol, and a cell
+ * pointing into the user dictionary becomes an offset from _sheap.
+ */
+#define IMAGE_DECLARE_NATIVE(name, flags, label) \
+  extern uint32_t forth_name_##label; \
+  extern uint32_t forth_##label;
+#define IMAGE_DECLARE_VAR(name, label, initial) \
+  IMAGE_DECLARE_NATIVE(name, 0, label) \
+  extern uint32_t forth_var_##name;
+#define IMAGE_DECLARE_WORD(name, flags, label, body) IMAGE_DECLARE_NATIVE(name, flags, label)
+
+extern "C" {
+FORTH_HOST_DICTIONARY(IMAGE_DECLARE_NATIVE, IMAGE_DECLARE_VAR, IMAGE_DECLARE_WORD)
+}
+
+struct ImageSymbol {
+  uint32_t addr;
+  const char *name;
+};
+
+#define IMAGE_NATIVE(name, flags, label) \
+  { addr_of(&forth_name_##label), "forth_name_" #label }, \
+  { addr_of(&forth_##label), "forth_" #label },
+#define IMAGE_VAR(name, label, initial) \
+  IMAGE_NATIVE(name, 0, label) \
+  { addr_of(&forth_var_##name), "forth_var_" #name },
+#define IMAGE_WORD(name, flags, label, body) IMAGE_NATIVE(name, flags, label)
+
+static const ImageSymbol image_symbols[] = {
+  { addr_of(&forth_code_do_colon), "forth_do_colon" },
+  { addr_of(&forth_code_do_const), "forth_do_const" },
+  { addr_of(&forth_code_do_var), "forth_do_var" },
+  { addr_of(&forth_code_do_value), "forth_do_value" },
+  FORTH_HOST_DICTIONARY(IMAGE_NATIVE, IMAGE_VAR, IMAGE_WORD)
+};
+
+/* Writes one cell of the image, as a symbol plus offset if it is an address. */
+static void forth_host_write_image_cell(FILE *out, uint32_t cell) {
+  if (cell >= addr_of(&_sheap) && cell <= forth_var_HERE) {
+    fprintf(out, "    .4byte _sheap+0x%x\n", cell - addr_of(&_sheap));
+    return;
+  }
+  for (const ImageSymbol &symbol : image_symbols) {
+    if (symbol.addr == cell) {
+      fprintf(out, "    .4byte %s\n", symbol.name);
+      return;
+    }
+  }
+  if (cell >= addr_of(&forth_dictionary_start) && cell < addr_of(&forth_dictionary_end)) {
+    // Into the middle of a builtin: the dictionary is laid out in order,
+    // so the nearest definition below it is the last one not past it.
+    const ImageSymbol *nearest = nullptr;
+    for (const ImageSymbol &symbol : image_symbols) {
+      if (symbol.addr <= cell && (nearest == nullptr || symbol.addr > nearest->addr)) {
+        nearest = &symbol;
+      }
+    }
+    fprintf(out, "    .4byte %s+0x%x\n", nearest->name, cell - nearest->addr);
+    return;
+  }
+  fprintf(out, "    .4byte 0x%08x\n", cell);
+}
+
+/*
+ * Writes the user dictionary, from _sheap to HERE, plus LATEST and HERE,
+ * as src/bootstrap_image.S. Fails if the dictionary holds anything that
+ * isn't just cells: natively compiled code, token threaded code, DOES>
+ * stubs, or flags toggled on builtins.
+ */
+bool forth_host_write_image(FILE *out) {
+  if (forth_var_STATE != 0) {
+    fprintf(stderr, "The bootstrap ends in the middle of a definition.\n");
+    return false;
+  }
+  for (uint32_t defn = forth_var_LATEST; defn >= addr_of(&_sheap); defn = *cell_at(defn)) {
+    if (*cell_at(*cell_at(defn + 4)) == addr_of(&forth_code_do_native)) {
+      fprintf(stderr, "The bootstrap image can't hold natively compiled words.\n");
+      return false;
+    }
+    // Their tokens index forth_token_table, which isn't in the image.
+    if (*cell_at(*cell_at(defn + 4)) == addr_of(&forth_code_do_tokens)) {
+      fprintf(stderr, "The bootstrap image can't hold token threaded words.\n");
+      return false;
+    }
+  }
+  // A DOES> stub is a bl on the board, but a code slot here.
+  for (uint32_t addr = addr_of(&_sheap); addr < forth_var_HERE; addr += 4) {
+    if (*cell_at(addr) == forth_code_do_does) {
+      fprintf(stderr, "The bootstrap image can't hold DOES> words.\n");
+      return false;
+    }
+  }
+  uint32_t overlay_size = (addr_of(&forth_dictionary_end) - addr_of(&forth_dictionary_start) + 7) / 8;
+  for (uint32_t i = 0; i < overlay_size; i++) {
+    if (forth_dictionary_overlay[i] != 0) {
+      fprintf(stderr, "The bootstrap image can't hold flags toggled on builtins.\n");
+      return false;
+    }
+  }
+
+  fprintf(out,
+      "/*\n"
+      " * bootstrap_image.S\n"
+      " *\n"
+      " * The user dictionary after interpreting the bootstrap in main.cpp.\n"
+      " * Generated by make -C host image: don't edit it, regenerate it.\n"
+      " */\n"
+      "\n"
+      "    .section .rodata.forth_bootstrap_image, \"a\"\n"
+      "    .balign 4\n"
+      "    .global forth_bootstrap_image, forth_bootstrap_image_end\n"
+      "    .global forth_bootstrap_image_latest, forth_bootstrap_image_here\n"
+      "\n"
+      "forth_bootstrap_image_latest:\n");
+  forth_host_write_image_cell(out, forth_var_LATEST);
+  fprintf(out, "forth_bootstrap_image_here:\n");
+  forth_host_write_image_cell(out, forth_var_HERE);
+  fprintf(out, "\nforth_bootstrap_image:\n");
+  for (uint32_t addr = addr_of(&_sheap); addr < forth_var_HERE; addr += 4) {
+    forth_host_write_image_cell(out, *cell_at(addr));
+  }
+  fprintf(out, "forth_bootstrap_image_end:\n");
+  return true;
+}
@@ -0,0 +1,149 @@
+/*
+ * host_main.cpp
+ *
+ * Runs PixieForth on a Linux host.
+ *
+ *   pixieforth -t          runs the unit tests in unit_tests.cpp, and checks
+ *                          interrupts from a timer thread
+ *   pixieforth -b          runs the benchmarks in benchmarks.cpp
+ *   pixieforth -s          compares THREADED and TOKENS code on the benchmarks
+ *   pixieforth -i image.S  writes the bootstrap image
+ *   pixieforth -c          checks the bootstrap image against the bootstrap
+ *   pixieforth [file...]   installs the bootstrap image, then runs each file
+ *
+ * With no files, it reads Forth from stdin until EOF, just like the board
+ * reads from serial.
+ */
+
+#include "WProgram.h"
+#include <forth_system.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern void run_unit_tests();
+extern void run_benchmarks();
+extern void report_token_sizes();
+extern void interpret();
+extern void install_bootstrap_image();
+extern uint32_t *const data_stack;
+extern bool check_bootstrap_image();
+extern bool forth_host_write_image(FILE *out);
+extern const char *bootstrap;
+extern void forth_host_raise_irq(int32_t irq);
+
+// Source files are read in here, so that STDIN can point at them.
+static char source[16 << 20];
+
+static void interpret_buffer(const char *buffer, uint32_t len) {
+  forth_var_STDIN = (uint32_t)(uintptr_t)buffer;
+  forth_var_STDIN_COUNT = len;
+  while (forth_var_STDIN_COUNT != 0) interpret();
+}
+
+static bool interpret_file(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (f == nullptr) {
+    perror(path);
+    return false;
+  }
+  size_t len = fread(source, 1, sizeof(source), f);
+  bool too_big = !feof(f);
+  fclose(f);
+  if (too_big) {
+    fprintf(stderr, "%s: too big\n", path);
+    return false;
+  }
+  // Trailing whitespace would leave INTERPRET with an empty word,
+  // which it reads as the number 0.
+  while (len != 0 && strchr(" \t\r\n", source[len - 1])) len--;
+  interpret_buffer(source, len);
+  return true;
+}
+
+/*
+ * A timer thread stands in for a timer peripheral: it raises IRQ 0 every
+ * 100us while the main thread runs Forth, and the word bound to IRQ 0
+ * counts them. Each tick waits for the last to be counted, since a pending
+ * IRQ raised again is still only one interrupt.
+ */
+#define TIMER_TICKS 200
+static volatile uint32_t timer_ticks;
+static volatile bool timer_done;
+
+static void *timer_thread(void *) {
+  for (uint32_t i = 0; i < TIMER_TICKS; i++) {
+    usleep(100);
+    forth_host_raise_irq(0);
+    while (timer_ticks == i) usleep(10);
+  }
+  timer_done = true;
+  return nullptr;
+}
+
+static bool check_timer_irq() {
+  static char setup[128]; // Forth addresses are 32 bits, so not on the stack
+  snprintf(setup, sizeof(setup),
+           ": TICK 1 %u +! ; ' TICK 0 BIND-IRQ 0 TO IRQ_LATENCY : SPIN 10000 0 DO LOOP ;",
+           (uint32_t)(uintptr_t)&timer_ticks);
+  interpret_buffer(setup, strlen(setup));
+  pthread_t thread;
+  pthread_create(&thread, nullptr, timer_thread, nullptr);
+  static const char spin[] = "SPIN";
+  while (!timer_done) interpret_buffer(spin, strlen(spin));
+  pthread_join(thread, nullptr);
+  bool ok = timer_ticks == TIMER_TICKS;
+  printf("Timer IRQ: %u of %u ticks, worst latency %u ns [%s]\n", timer_ticks, TIMER_TICKS,
+         forth_var_IRQ_LATENCY, ok ? "PASS" : "FAIL");
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  sp = data_stack;
+  // The engine fills in its code fields the first time it runs. Get that
+  // out of the way so that it doesn't get timed.
+  sp = forth_enter(sp, &forth_quit);
+
+  if (argc == 2 && !strcmp(argv[1], "-t")) {
+    run_unit_tests();
+    return check_timer_irq() ? 0 : 1;
+  }
+  if (argc == 2 && !strcmp(argv[1], "-b")) {
+    run_benchmarks();
+    return 0;
+  }
+  if (argc == 2 && !strcmp(argv[1], "-s")) {
+    report_token_sizes();
+    return 0;
+  }
+
+  if (argc == 3 && !strcmp(argv[1], "-i")) {
+    interpret_buffer(bootstrap, strlen(bootstrap));
+    forth_flush_output();
+    FILE *f = fopen(argv[2], "w");
+    if (f == nullptr) {
+      perror(argv[2]);
+      return 1;
+    }
+    bool ok = forth_host_write_image(f);
+    return fclose(f) == 0 && ok ? 0 : 1;
+  }
+  if (argc == 2 && !strcmp(argv[1], "-c")) {
+    return check_bootstrap_image() ? 0 : 1;
+  }
+
+  install_bootstrap_image();
+  for (int i = 1; i < argc; i++) {
+    if (!interpret_file(argv[i])) return 1;
+  }
+  forth_flush_output();
+  if (argc > 1) return 0;
+
+  // usb_serial_getchar exits at the end of stdin, which may leave output
+  // in the buffer under FLUSH-WHEN-FULL.
+  atexit(forth_flush_output);
+  forth_var_STDIN = 0;
+  while (true) interpret();
+}
@@ -0,0 +1,49 @@
+/*
+ * kinetis.h
+ *
+ * Stands in for the Teensy core's kinetis.h in the host build. Only the
+ * DWT cycle counter is here, and on the host it counts nanoseconds. So
+ * that cycles convert to seconds, F_CPU is a nanosecond clock.
+ */
+
+#ifndef HOST_KINETIS_H_
+#define HOST_KINETIS_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#ifndef F_CPU
+#define F_CPU 1000000000
+#endif
+
+class HostCycleCounter {
+ public:
+  operator uint32_t() const {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(now.tv_sec * 1000000000ull + now.tv_nsec) - base_;
+  }
+  HostCycleCounter &operator=(uint32_t count) {
+    base_ = 0;
+    base_ = uint32_t(*this) - count;
+    return *this;
+  }
+
+ private:
+  uint32_t base_ = 0;
+};
+
+inline uint32_t host_arm_demcr;
+inline uint32_t host_arm_dwt_ctrl;
+inline HostCycleCounter host_arm_dwt_cyccnt;
+
+#define ARM_DEMCR host_arm_demcr
+#define ARM_DEMCR_TRCENA (1 << 24)
+#define ARM_DWT_CTRL host_arm_dwt_ctrl
+#define ARM_DWT_CTRL_CYCCNTENA (1 << 0)
+#define ARM_DWT_CYCCNT host_arm_dwt_cyccnt
+
+inline void __disable_irq() {}
+inline void __enable_irq() {}
+
+#endif /* HOST_KINETIS_H_ */
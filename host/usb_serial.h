@@ -0,0 +1,52 @@
+/*
+ * usb_serial.h
+ *
+ * Stands in for the Teensy core's USB serial in the host build. The
+ * serial port is the process's stdin and stdout. There's no one to wait
+ * for once stdin is closed, so that ends the program. stdin is read
+ * without stdio's buffering, so that usb_serial_available can tell what
+ * has arrived.
+ */
+
+#ifndef HOST_USB_SERIAL_H_
+#define HOST_USB_SERIAL_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+inline int usb_serial_read(void *buffer, uint32_t size) {
+  ssize_t len = read(0, buffer, size);
+  if (len <= 0) {
+    fflush(stdout);
+    exit(0);
+  }
+  return len;
+}
+
+inline int usb_serial_getchar(void) {
+  uint8_t c;
+  usb_serial_read(&c, 1);
+  return c;
+}
+
+inline int usb_serial_available(void) {
+  int len;
+  return ioctl(0, FIONREAD, &len) == 0 ? len : 0;
+}
+
+inline int usb_serial_putchar(uint8_t c) {
+  return putchar(c) == EOF ? -1 : 0;
+}
+
+inline int usb_serial_write(const void *buffer, uint32_t size) {
+  return fwrite(buffer, 1, size, stdout) == size ? 0 : -1;
+}
+
+inline void usb_serial_flush_output(void) {
+  fflush(stdout);
+}
+
+#endif /* HOST_USB_SERIAL_H_ */
@@ -0,0 +1,426 @@
+/*
+ * benchmarks.cpp
+ *
+ * A suite of classic Forth kernels for judging changes to the inner
+ * interpreter, the dispatch, or the register ABI. Each kernel is run a
+ * number of times and reported in cycles per iteration. If forth_system.S
+ * (or the host engine) was built with FORTH_COUNT_DISPATCH, the report
+ * also has dispatches per iteration, dispatches per second and cycles per
+ * dispatch, although then the cycles include the counting.
+ *
+ * The number to track is the SCORE at the end: the geometric mean of the
+ * cycles per iteration over all the kernels. Lower is better.
+ *
+ * On the board, cycles come from the DWT cycle counter. On the host, the
+ * counter counts nanoseconds, so there a cycle is a nanosecond.
+ */
+
+#include <forth_system.h>
+#include "WProgram.h"
+#include <usb_serial.h>
+#include <kinetis.h>
+#include <math.h>
+
+extern uint32_t *const data_stack;
+extern void interpret();
+
+struct Benchmark {
+  const char* name;
+  const char* source; // Forth that defines the kernel, interpreted once
+  const char* word; // the kernel, ( -- result ), or nullptr to time the source
+  const uint32_t iterations;
+  const uint32_t expected; // the result
+};
+
+/*
+ * The core has no control structures, so the benchmarks bring their own,
+ * built from BRANCH and 0BRANCH the way JonesForth does. ALLOT only takes
+ * multiples of 4.
+ */
+static const char *prelude = R"END(
+  : IF [ ' 0BRANCH ] LITERAL , HERE 0 , ; IMMEDIATE
+  : THEN DUP HERE SWAP - 4 / 1- SWAP ! ; IMMEDIATE
+  : ELSE [ ' BRANCH ] LITERAL , HERE 0 , SWAP DUP HERE SWAP - 4 / 1- SWAP ! ; IMMEDIATE
+  : BEGIN HERE ; IMMEDIATE
+  : UNTIL [ ' 0BRANCH ] LITERAL , HERE - 4 / 1- , ; IMMEDIATE
+  : AGAIN [ ' BRANCH ] LITERAL , HERE - 4 / 1- , ; IMMEDIATE
+  : WHILE [ ' 0BRANCH ] LITERAL , HERE 0 , SWAP ; IMMEDIATE
+  : REPEAT [ ' BRANCH ] LITERAL , HERE - 4 / 1- , DUP HERE SWAP - 4 / 1- SWAP ! ; IMMEDIATE
+  : RECURSE LATEST >CFA COMPILE, ; IMMEDIATE
+  : CELLS 4 * ;
+  : ALLOT BEGIN DUP WHILE 0 , 4- REPEAT DROP ;
+)END";
+
+static Benchmark benchmarks[] {
+    {
+        // Doubly recursive Fibonacci: calls and returns.
+        "fib",
+        R"END(
+          : FIB DUP 2 < IF EXIT THEN DUP 1- RECURSE SWAP 2 - RECURSE + ;
+          : FIB-BENCH 20 FIB ;
+        )END",
+        "FIB-BENCH", 10, 6765
+    },
+    {
+        // The BYTE sieve of Eratosthenes over 8190 flags: byte access and loops.
+        "sieve",
+        R"END(
+          HERE 8192 ALLOT : FLAGS LITERAL ;
+          : CLEAR-MULTIPLES BEGIN DUP 8190 < WHILE 0 OVER FLAGS + C! OVER + REPEAT 2DROP ;
+          : SIEVE-BENCH
+            0 BEGIN DUP 8190 < WHILE 1 OVER FLAGS + C! 1+ REPEAT DROP
+            0 0 BEGIN DUP 8190 < WHILE
+              DUP FLAGS + C@ IF
+                DUP DUP + 3 + OVER OVER + CLEAR-MULTIPLES
+                SWAP 1+ SWAP
+              THEN 1+
+            REPEAT DROP ;
+        )END",
+        "SIEVE-BENCH", 10, 1899
+    },
+    {
+        // Bubble sort of 100 cells in reverse order: cell access and stack shuffling.
+        "bubble sort",
+        R"END(
+          HERE 400 ALLOT : ARRAY LITERAL ;
+          : INIT-ARRAY 0 BEGIN DUP 100 < WHILE 100 OVER - OVER CELLS ARRAY + ! 1+ REPEAT DROP ;
+          : BUBBLE
+            99 BEGIN DUP WHILE
+              0 BEGIN 2DUP > WHILE
+                DUP CELLS ARRAY + DUP @ OVER 4+ @
+                2DUP > IF ROT DUP >R ! R> 4+ ! ELSE 2DROP DROP THEN
+                1+
+              REPEAT DROP 1-
+            REPEAT DROP ;
+          : SORTED? 1 0 BEGIN DUP 99 < WHILE
+              DUP CELLS ARRAY + DUP @ SWAP 4+ @ > IF SWAP DROP 0 SWAP THEN 1+
+            REPEAT DROP ;
+          : BUBBLE-BENCH INIT-ARRAY BUBBLE SORTED? ;
+        )END",
+        "BUBBLE-BENCH", 10, 1
+    },
+    {
+        // 10x10 integer matrix multiply: multiplies and the return stack.
+        "matrix multiply",
+        R"END(
+          HERE 400 ALLOT : MA LITERAL ;
+          HERE 400 ALLOT : MB LITERAL ;
+          HERE 400 ALLOT : MC LITERAL ;
+          : IDX SWAP 10 * + CELLS ;
+          : INIT-MATRICES 0 BEGIN DUP 100 < WHILE
+              DUP OVER CELLS MA + ! DUP 1+ OVER CELLS MB + ! 1+
+            REPEAT DROP ;
+          : DOT 0 10 BEGIN DUP WHILE >R
+              >R OVER @ OVER @ * R> +
+              ROT 4+ ROT 40 + ROT
+              R> 1-
+            REPEAT DROP NIP NIP ;
+          : MATMUL 0 BEGIN DUP 10 < WHILE
+              0 BEGIN DUP 10 < WHILE
+                OVER 40 * MA + OVER CELLS MB + DOT
+                >R 2DUP IDX MC + R> SWAP !
+                1+
+              REPEAT DROP 1+
+            REPEAT DROP ;
+          : CHECKSUM 0 0 BEGIN DUP 100 < WHILE DUP CELLS MC + @ ROT + SWAP 1+ REPEAT DROP ;
+          : MATMUL-BENCH INIT-MATRICES MATMUL CHECKSUM ;
+        )END",
+        "MATMUL-BENCH", 100, 2582250
+    },
+    {
+        // Naive search for a 4 byte pattern at the end of 1024 bytes of text.
+        "string search",
+        R"END(
+          HERE 1024 ALLOT : TEXT LITERAL ;
+          HERE 4 ALLOT : PATTERN LITERAL ;
+          : INIT-TEXT
+            0 BEGIN DUP 1024 < WHILE DUP 7 * 26 /MOD DROP 65 + OVER TEXT + C! 1+ REPEAT DROP
+            70 PATTERN C! 79 PATTERN 1+ C! 82 PATTERN 2 + C! 84 PATTERN 3 + C!
+            PATTERN @ TEXT 1020 + ! ;
+          : MATCH? 0 BEGIN DUP 4 < WHILE
+              2DUP + C@ OVER PATTERN + C@ <> IF 2DROP 0 EXIT THEN
+              1+
+            REPEAT 2DROP -1 ;
+          : SEARCH 0 BEGIN DUP 1021 < WHILE
+              DUP TEXT + MATCH? IF EXIT THEN
+              1+
+            REPEAT DROP -1 ;
+          INIT-TEXT
+          : SEARCH-BENCH SEARCH ;
+        )END",
+        "SEARCH-BENCH", 100, 1020
+    },
+    {
+        // Compiling definitions from source: WORD, FIND, NUMBER and the
+        // compile path. The definitions are forgotten after each iteration.
+        "dictionary compile",
+        R"END(
+          : D1 DUP 1+ SWAP 1- + ;
+          : D2 D1 D1 2 * ;
+          : D3 BEGIN DUP WHILE 1- REPEAT ;
+          : D4 0< IF -1 ELSE 1 THEN ;
+          : D5 OVER OVER > IF SWAP THEN DROP ;
+          : D6 BASE 10 = IF 1 ELSE 0 THEN ;
+          : D7 2 3 + 4 * 5 - D1 D2 ;
+          : D8 0 BEGIN 1+ DUP 10 = UNTIL ;
+          : D9 HERE LATEST - 0> ;
+          : D10 D7 D8 D5 D3 D4 ;
+          : D11 DUP * DUP * D1 D1 D1 DROP ;
+          : D12 D10 D6 + D9 + ;
+          D12
+        )END",
+        nullptr, 20, 1
+    },
+};
+
+/* Interprets the source, ignoring trailing whitespace. */
+static void interpret_source(const char *source) {
+  uint32_t len = strlen(source);
+  while (len != 0 && strchr(" \t\r\n", source[len - 1])) len--;
+  forth_var_STDIN = (uint32_t) source;
+  forth_var_STDIN_COUNT = len;
+  while (forth_var_STDIN_COUNT != 0) interpret();
+}
+
+/* Finds a visible definition's code field address, or returns 0. */
+static uint32_t find_word(const char *word) {
+  uint32_t word_len = strlen(word);
+  for (uint32_t def_ptr = forth_var_LATEST; def_ptr != 0; def_ptr = *(uint32_t *)def_ptr) {
+    uint8_t len = *(uint8_t *)(def_ptr + 8);
+    if ((len & 0x3f) != word_len) continue;
+    if (memcmp((void *)(def_ptr + 9), word, word_len)) continue;
+    return *(uint32_t *)(def_ptr + 4);
+  }
+  return 0;
+}
+
+/* Prints n with at least width characters, right justified. */
+static void print_padded(uint32_t n, int width) {
+  int digits = 1;
+  for (uint32_t rest = n / 10; rest != 0; rest /= 10) digits++;
+  for (int i = digits; i < width; i++) Serial.print(' ');
+  Serial.print(n);
+}
+
+void run_benchmarks() {
+  // Set up cycle counting
+
+  ARM_DEMCR |= ARM_DEMCR_TRCENA; // enable debugging and monitoring blocks
+  ARM_DWT_CYCCNT = 0; // reset the cycle count
+  ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA; // enable cycle count
+
+  Serial.println("BENCHMARKS");
+  Serial.println();
+  Serial.println("                       iterations  cycles/iter  dispatches/iter  dispatches/s  cycles/dispatch");
+
+  sp = data_stack;
+  interpret_source(prelude);
+
+  static uint32_t program[] = { (uint32_t)&forth_do_colon, 0, (uint32_t)&forth_exit };
+  double log_sum = 0;
+  uint32_t count = 0;
+
+  for (int i = 0; i < sizeof(benchmarks)/sizeof(Benchmark); i++) {
+    const Benchmark &bench = benchmarks[i];
+    Serial.print(bench.name);
+    Serial.print("...");
+    for (int j = 0; j < 20 - strlen(bench.name); j++) Serial.print(' ');
+
+    uint32_t here = forth_var_HERE;
+    uint32_t latest = forth_var_LATEST;
+    if (bench.word != nullptr) {
+      interpret_source(bench.source);
+      program[1] = find_word(bench.word);
+      if (program[1] == 0) {
+        Serial.println("[FAIL] kernel didn't compile");
+        continue;
+      }
+    }
+
+    bool failed = false;
+    uint64_t cycles = 0;
+    uint64_t dispatches = 0;
+
+    for (uint32_t j = 0; j < bench.iterations; j++) {
+      sp = data_stack;
+      forth_dispatch_count = 0;
+
+      __disable_irq();
+      uint32_t count_start = ARM_DWT_CYCCNT;
+
+      if (bench.word != nullptr) {
+        sp = forth_enter(sp, program);
+      } else {
+        interpret_source(bench.source);
+      }
+
+      uint32_t count_end = ARM_DWT_CYCCNT;
+      __enable_irq();
+
+      cycles += count_end - count_start;
+      dispatches += forth_dispatch_count;
+      if (sp != data_stack + 1 || data_stack[0] != bench.expected) failed = true;
+      if (bench.word == nullptr) {
+        forth_var_HERE = here;
+        forth_var_LATEST = latest;
+        forth_peephole_here = 0;
+      }
+    }
+
+    if (failed) {
+      Serial.print("[FAIL] expected ");
+      Serial.print(bench.expected);
+      Serial.print(" but got (");
+      Serial.print((uint32_t) (sp - data_stack));
+      Serial.print("): -- ");
+      for (uint32_t *ptr = data_stack; ptr < sp; ptr++) {
+        Serial.print(*ptr);
+        Serial.print(" ");
+      }
+      Serial.println();
+      continue;
+    }
+
+    uint32_t cycles_per_iter = cycles / bench.iterations;
+    print_padded(bench.iterations, 10);
+    print_padded(cycles_per_iter, 13);
+    if (dispatches != 0) {
+      print_padded(dispatches / bench.iterations, 17);
+      print_padded(dispatches * F_CPU / cycles, 14);
+      uint32_t tenths = cycles * 10 / dispatches;
+      print_padded(tenths / 10, 15);
+      Serial.print('.');
+      Serial.print(tenths % 10);
+    } else {
+      Serial.print("                -             -                -");
+    }
+    Serial.println();
+
+    log_sum += log(cycles_per_iter);
+    count++;
+  }
+
+  Serial.println();
+  Serial.print("SCORE (geometric mean of cycles/iter, lower is better): ");
+  Serial.println(count == 0 ? 0 : (uint32_t) (exp(log_sum / count) + 0.5));
+}
+
+/*
+ * The prelude's control structures lay down cell offsets with , so they
+ * only work in THREADED definitions. These use >MARK, >RESOLVE and
+ * <RESOLVE, which lay down offsets for whatever THREADING is.
+ */
+static const char *mode_prelude = R"END(
+  : IF [ ' 0BRANCH ] LITERAL COMPILE, >MARK ; IMMEDIATE
+  : THEN >RESOLVE ; IMMEDIATE
+  : ELSE [ ' BRANCH ] LITERAL COMPILE, >MARK SWAP >RESOLVE ; IMMEDIATE
+  : BEGIN HERE ; IMMEDIATE
+  : UNTIL [ ' 0BRANCH ] LITERAL COMPILE, <RESOLVE ; IMMEDIATE
+  : AGAIN [ ' BRANCH ] LITERAL COMPILE, <RESOLVE ; IMMEDIATE
+  : WHILE [ ' 0BRANCH ] LITERAL COMPILE, >MARK SWAP ; IMMEDIATE
+  : REPEAT [ ' BRANCH ] LITERAL COMPILE, <RESOLVE >RESOLVE ; IMMEDIATE
+  : RECURSE LATEST >CFA COMPILE, ; IMMEDIATE
+  : CELLS 4 * ;
+  : ALLOT BEGIN DUP WHILE 0 , 4- REPEAT DROP ;
+)END";
+
+/*
+ * Compiles each kernel's source as THREADED and then as TOKENS code, and
+ * reports how much dictionary it took and how fast the kernel ran each
+ * way. The kernels, and the tokens they added, are forgotten after each.
+ */
+void report_token_sizes() {
+  // Set up cycle counting
+
+  ARM_DEMCR |= ARM_DEMCR_TRCENA; // enable debugging and monitoring blocks
+  ARM_DWT_CYCCNT = 0; // reset the cycle count
+  ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA; // enable cycle count
+
+  Serial.println("TOKEN THREADING");
+  Serial.println();
+  Serial.println("                         threaded bytes  token bytes  token/threaded  threaded cycles/iter  token cycles/iter");
+
+  uint32_t start_here = forth_var_HERE;
+  uint32_t start_latest = forth_var_LATEST;
+  sp = data_stack;
+  interpret_source(mode_prelude);
+
+  static uint32_t program[] = { (uint32_t)&forth_do_colon, 0, (uint32_t)&forth_exit };
+  uint32_t *modes[] = { &forth_threaded_mode, &forth_token_mode };
+  uint32_t total_bytes[2] = { 0, 0 };
+
+  for (int i = 0; i < sizeof(benchmarks)/sizeof(Benchmark); i++) {
+    const Benchmark &bench = benchmarks[i];
+    Serial.print(bench.name);
+    Serial.print("...");
+    for (int j = 0; j < 22 - strlen(bench.name); j++) Serial.print(' ');
+
+    uint32_t bytes[2] = { 0, 0 };
+    uint32_t cycles_per_iter[2] = { 0, 0 };
+    bool failed = false;
+
+    for (int mode = 0; mode < 2; mode++) {
+      uint32_t here = forth_var_HERE;
+      uint32_t latest = forth_var_LATEST;
+      uint32_t token_count = forth_token_count;
+      program[1] = (uint32_t)modes[mode];
+      sp = forth_enter(data_stack, program);
+      interpret_source(bench.source);
+      bytes[mode] = forth_var_HERE - here;
+
+      uint32_t cfa = bench.word == nullptr ? 0 : find_word(bench.word);
+      if (bench.word != nullptr && cfa == 0) failed = true;
+      uint64_t cycles = 0;
+      program[1] = cfa;
+      for (uint32_t j = 0; cfa != 0 && j < bench.iterations; j++) {
+        __disable_irq();
+        uint32_t count_start = ARM_DWT_CYCCNT;
+        sp = forth_enter(data_stack, program);
+        uint32_t count_end = ARM_DWT_CYCCNT;
+        __enable_irq();
+
+        cycles += count_end - count_start;
+        if (sp != data_stack + 1 || data_stack[0] != bench.expected) failed = true;
+      }
+      cycles_per_iter[mode] = cycles / bench.iterations;
+
+      forth_var_HERE = here;
+      forth_var_LATEST = latest;
+      forth_peephole_here = 0;
+      forth_token_count = token_count;
+    }
+    program[1] = (uint32_t)&forth_threaded_mode;
+    sp = forth_enter(data_stack, program);
+
+    if (failed) {
+      Serial.println("[FAIL] kernel didn't compile or got the wrong result");
+      continue;
+    }
+    total_bytes[0] += bytes[0];
+    total_bytes[1] += bytes[1];
+    print_padded(bytes[0], 14);
+    print_padded(bytes[1], 13);
+    print_padded(bytes[1] * 100 / bytes[0], 15);
+    Serial.print("%");
+    if (bench.word != nullptr) {
+      print_padded(cycles_per_iter[0], 21);
+      print_padded(cycles_per_iter[1], 19);
+    } else {
+      Serial.print("                    -                  -");
+    }
+    Serial.println();
+  }
+
+  Serial.println();
+  Serial.print("TOTAL");
+  for (int j = 0; j < 25 - 5; j++) Serial.print(' ');
+  print_padded(total_bytes[0], 14);
+  print_padded(total_bytes[1], 13);
+  print_padded(total_bytes[0] == 0 ? 0 : total_bytes[1] * 100 / total_bytes[0], 15);
+  Serial.println("%");
+
+  forth_var_HERE = start_here;
+  forth_var_LATEST = start_latest;
+  forth_peephole_here = 0;
+  sp = data_stack;
+}
@@ -10,96 +10,291 @@
 
 #include <stdint.h>
 
+#if defined(FORTH_PROFILE_NEXT) && !defined(FORTH_PROFILE)
+#define FORTH_PROFILE
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 extern uint32_t _sheap;
 extern uint32_t _eheap;
+extern uint32_t _sstack;
 extern uint32_t _estack;
 
 extern uint32_t *sp;
-extern uint32_t data_stack[];
 
+/* param_stack needs a cell under its bottom, where an empty stack's tos goes. */
 extern uint32_t* forth_enter(uint32_t* param_stack, uint32_t const* forth_word);
+extern void forth_flush_output(void);
+extern uint32_t forth_inline_length(uint32_t code_addr, uint32_t most);
+extern uint32_t forth_code_routine(uint32_t code_addr);
+extern uint32_t forth_code_field(uint32_t routine, uint32_t code_addr);
 
 extern uint32_t forth_2drop;
 extern uint32_t forth_2dup;
 extern uint32_t forth_2swap;
+extern uint32_t forth_accept;
 extern uint32_t forth_add;
 extern uint32_t forth_addstore;
 extern uint32_t forth_and;
 extern uint32_t forth_base;
+extern uint32_t forth_bind_irq;
 extern uint32_t forth_branch;
 extern uint32_t forth_brancheq;
 extern uint32_t forth_char;
 extern uint32_t forth_char_newline;
 extern uint32_t forth_char_space;
 extern uint32_t forth_code_field_addr_of_next_word;
+extern uint32_t forth_compile_comma;
 extern uint32_t forth_compile_def;
 extern uint32_t forth_compile_mode;
+extern uint32_t forth_constant;
+extern uint32_t forth_cr;
 extern uint32_t forth_create;
+extern uint32_t forth_create_named;
+extern uint32_t forth_dadd;
 extern uint32_t forth_dec;
 extern uint32_t forth_dec4;
 extern uint32_t forth_div;
 extern uint32_t forth_divmod;
+extern uint32_t forth_dlt;
+extern uint32_t forth_dnegate;
+extern uint32_t forth_do;
 extern uint32_t forth_do_colon;
+extern uint32_t forth_do_const;
+extern uint32_t forth_do_does;
+extern uint32_t forth_do_native;
+extern uint32_t forth_do_tokens;
+extern uint32_t forth_do_value;
+extern uint32_t forth_do_var;
+extern uint32_t forth_does;
 extern uint32_t forth_drop;
+extern uint32_t forth_dsub;
 extern uint32_t forth_dup;
+extern uint32_t forth_dup_brancheq;
 extern uint32_t forth_end_compile_def;
+extern uint32_t forth_epilogue;
 extern uint32_t forth_eq;
 extern uint32_t forth_eqz;
 extern uint32_t forth_exit;
+extern uint32_t forth_f_to_s;
+extern uint32_t forth_fabs;
+extern uint32_t forth_fadd;
+extern uint32_t forth_fdiv;
+extern uint32_t forth_fdrop;
+extern uint32_t forth_fdup;
+extern uint32_t forth_feqz;
 extern uint32_t forth_fetch;
+extern uint32_t forth_fetch_add;
 extern uint32_t forth_fetch_char;
+extern uint32_t forth_fetch_return;
+extern uint32_t forth_ffetch;
 extern uint32_t forth_find;
+extern uint32_t forth_fliteral;
+extern uint32_t forth_flt;
+extern uint32_t forth_fltz;
+extern uint32_t forth_flush;
+extern uint32_t forth_flush_on_idle;
+extern uint32_t forth_flush_on_newline;
+extern uint32_t forth_flush_when_full;
+extern uint32_t forth_fm_divmod;
+extern uint32_t forth_fmul;
+extern uint32_t forth_fnegate;
+extern uint32_t forth_fover;
+extern uint32_t forth_fsqrt;
+extern uint32_t forth_fstore;
+extern uint32_t forth_fsub;
+extern uint32_t forth_fswap;
 extern uint32_t forth_ge;
 extern uint32_t forth_gez;
 extern uint32_t forth_gt;
 extern uint32_t forth_gtz;
 extern uint32_t forth_here;
+extern uint32_t forth_hide;
+extern uint32_t forth_i;
 extern uint32_t forth_immediate_mode;
 extern uint32_t forth_inc;
 extern uint32_t forth_inc4;
 extern uint32_t forth_interpret;
+extern uint32_t forth_irq_latency;
+extern uint32_t forth_j;
 extern uint32_t forth_key;
 extern uint32_t forth_latest;
 extern uint32_t forth_le;
+extern uint32_t forth_leave;
 extern uint32_t forth_lez;
 extern uint32_t forth_lit;
+extern uint32_t forth_lit_add;
 extern uint32_t forth_literal;
+extern uint32_t forth_loop;
+extern uint32_t forth_lshift;
 extern uint32_t forth_lt;
 extern uint32_t forth_ltz;
+extern uint32_t forth_mark_forward;
+extern uint32_t forth_maybe_do;
 extern uint32_t forth_maybe_dup;
 extern uint32_t forth_memcpy;
 extern uint32_t forth_memmove;
+extern uint32_t forth_mmul;
 extern uint32_t forth_mul;
+extern uint32_t forth_native_mode;
 extern uint32_t forth_ne;
 extern uint32_t forth_nez;
+extern uint32_t forth_nip;
 extern uint32_t forth_not;
 extern uint32_t forth_nrot;
 extern uint32_t forth_number;
 extern uint32_t forth_or;
 extern uint32_t forth_over;
+extern uint32_t forth_param_to_return;
+extern uint32_t forth_paren_do;
+extern uint32_t forth_paren_does;
+extern uint32_t forth_paren_fliteral;
+extern uint32_t forth_paren_loop;
+extern uint32_t forth_paren_maybe_do;
+extern uint32_t forth_paren_plus_loop;
+extern uint32_t forth_paren_tail;
+extern uint32_t forth_parse_name;
+extern uint32_t forth_pause;
+extern uint32_t forth_plus_loop;
+extern uint32_t forth_profile_dump;
+extern uint32_t forth_profile_reset;
+extern uint32_t forth_profile_sort;
+extern uint32_t forth_prologue;
 extern uint32_t forth_quit;
+extern uint32_t forth_refill;
+extern uint32_t forth_resolve_backward;
+extern uint32_t forth_resolve_forward;
+extern uint32_t forth_return_to_param;
 extern uint32_t forth_rot;
+extern uint32_t forth_rshift;
+extern uint32_t forth_s_to_f;
+extern uint32_t forth_sm_divrem;
+extern uint32_t forth_source;
+extern uint32_t forth_star_slash;
+extern uint32_t forth_star_slash_mod;
+extern uint32_t forth_start;
+extern uint32_t forth_stdin;
+extern uint32_t forth_stop;
 extern uint32_t forth_store;
 extern uint32_t forth_store_char;
+extern uint32_t forth_store_return;
 extern uint32_t forth_store_to_here;
 extern uint32_t forth_sub;
 extern uint32_t forth_substore;
 extern uint32_t forth_swap;
+extern uint32_t forth_tail_call_comma;
+extern uint32_t forth_tail_calls_off;
+extern uint32_t forth_tail_calls_on;
+extern uint32_t forth_task;
+extern uint32_t forth_threaded_mode;
+extern uint32_t forth_to;
 extern uint32_t forth_to_code_field_addr;
 extern uint32_t forth_to_data_field_addr;
+extern uint32_t forth_to_in;
 extern uint32_t forth_toggle_hidden;
+extern uint32_t forth_toggle_inline;
+extern uint32_t forth_token_mode;
+extern uint32_t forth_trigger_irq;
+extern uint32_t forth_type;
+extern uint32_t forth_um_divmod;
+extern uint32_t forth_umul;
+extern uint32_t forth_unloop;
+extern uint32_t forth_vadd;
+extern uint32_t forth_value;
+extern uint32_t forth_variable;
+extern uint32_t forth_vcadd;
+extern uint32_t forth_vcadd_sat;
+extern uint32_t forth_vcmul;
+extern uint32_t forth_vcsad;
+extern uint32_t forth_vcsub;
+extern uint32_t forth_vhadd;
+extern uint32_t forth_vhadd_sat;
+extern uint32_t forth_vhdot;
+extern uint32_t forth_vhmac;
+extern uint32_t forth_vhmax;
+extern uint32_t forth_vhmin;
+extern uint32_t forth_vhmul;
+extern uint32_t forth_vhsub;
+extern uint32_t forth_vhsum;
+extern uint32_t forth_vmax;
+extern uint32_t forth_vmin;
+extern uint32_t forth_vmul;
+extern uint32_t forth_vsub;
+extern uint32_t forth_vsum;
 extern uint32_t forth_word;
 extern uint32_t forth_xor;
 
+extern uint32_t forth_bootstrap_image;
+extern uint32_t forth_bootstrap_image_end;
+extern uint32_t forth_bootstrap_image_here;
+extern uint32_t forth_bootstrap_image_latest;
+
+extern uint32_t forth_dictionary_end;
+extern uint8_t forth_dictionary_overlay[];
+extern uint32_t forth_dictionary_start;
+
+extern uint32_t forth_find_index_buckets;
+extern uint32_t forth_find_index_lookups;
+extern uint32_t forth_find_index_nodes;
+extern uint32_t forth_find_index_overflow;
+extern uint32_t forth_find_index_probes;
+extern uint32_t forth_find_index_rebuilds;
+extern uint32_t forth_find_index_size;
+
+extern uint32_t forth_fold_rules;
+extern uint32_t forth_peephole_fold_size;
+extern uint32_t forth_peephole_folds;
+extern uint32_t forth_peephole_fusions;
+extern uint32_t forth_peephole_here;
+extern uint32_t forth_peephole_immediate_here;
+extern uint32_t forth_peephole_literals;
+extern uint32_t forth_peephole_rules;
+extern uint32_t forth_peephole_size;
+
+extern uint32_t forth_float_stack;
+extern uint32_t forth_fsp;
+
+extern uint32_t forth_irq_words;
+
+extern uint32_t forth_task_current;
+extern uint32_t forth_task_main;
+
+extern uint32_t forth_token_count;
+extern uint32_t forth_token_ip;
+extern uint32_t forth_token_size;
+extern uint32_t forth_token_table;
+
+extern uint32_t forth_dispatch_count;
+
+extern uint32_t forth_source_in;
+extern uint32_t forth_source_tib_count;
+extern uint32_t forth_source_tib_received;
+extern uint32_t forth_tib;
+
+extern uint32_t forth_output_buffer;
+extern uint32_t forth_output_head;
+extern uint32_t forth_output_tail;
+
+extern uint32_t forth_profile_count;
+extern uint32_t forth_profile_depth;
+extern uint32_t forth_profile_dropped;
+extern uint32_t forth_profile_order;
+extern uint32_t forth_profile_records;
+
+extern uint32_t forth_var_BASE;
+extern uint32_t forth_var_FLUSH_POLICY;
 extern uint32_t forth_var_HERE;
+extern uint32_t forth_var_INLINE_SIZE;
+extern uint32_t forth_var_IRQ_LATENCY;
 extern uint32_t forth_var_LATEST;
 extern uint32_t forth_var_STATE;
 extern uint32_t forth_var_STDIN;
 extern uint32_t forth_var_STDIN_COUNT;
+extern uint32_t forth_var_TAIL_CALLS;
+extern uint32_t forth_var_THREADING;
 
 #ifdef __cplusplus
 }
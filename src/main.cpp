@@ -4,17 +4,33 @@
 #include <forth_system.h>
 
 extern void run_unit_tests();
+extern void run_benchmarks();
+extern void report_token_sizes();
 extern void interpret();
 extern const char *bootstrap;
 
 static constexpr int stack_size = 1024;
 uint32_t *sp;
-uint32_t data_stack[stack_size];
+static uint32_t data_stack_cells[stack_size + 1]; // with a cell under the bottom for forth_enter
+extern uint32_t *const data_stack = data_stack_cells + 1;
 
 inline uint32_t word_at(uint32_t addr) {
   return *(uint32_t *)addr;
 }
 
+/*
+ * The len + flags byte of a definition. Builtin headers are in flash, so
+ * HIDDEN and IMMEDIATE toggle their flags in forth_dictionary_overlay.
+ */
+uint8_t flags_of(uint32_t def_ptr) {
+  uint8_t flags = *(uint8_t *)(def_ptr + 8);
+  uint32_t start = (uint32_t)&forth_dictionary_start;
+  if (def_ptr < (uint32_t)&forth_dictionary_end) {
+    flags ^= forth_dictionary_overlay[(def_ptr - start) >> 3];
+  }
+  return flags;
+}
+
 void dump_stack() {
   uint32_t *ptr = data_stack;
   Serial.print("-- ");
@@ -44,7 +60,7 @@ void dump_word(const char *word) {
   uint32_t word_len = strlen(word);
 
   for (uint32_t word_ptr = forth_var_LATEST; word_ptr != 0; word_ptr = word_at(word_ptr)) {
-    uint8_t len = *(uint8_t *)(word_ptr + 8);
+    uint8_t len = flags_of(word_ptr);
     if ((len & 31) != word_len) continue;
     if (memcmp((void *)(word_ptr + 9), word, word_len)) continue;
     Serial.print("Found word ");
@@ -60,12 +76,49 @@ void dump_word(const char *word) {
     }
 
     word_ptr = word_at(word_ptr + 4);
-    if (word_at(word_ptr) != (uint32_t)&forth_do_colon) {
+    uint32_t routine = forth_code_routine(word_ptr);
+    if (routine == (uint32_t)&forth_do_native) {
+      Serial.println("  It is a natively compiled word.");
+      return;
+    }
+    if (routine == (uint32_t)&forth_do_tokens) {
+      Serial.println("  It is a token threaded word.");
+      return;
+    }
+    if (routine == (uint32_t)&forth_do_const) {
+      Serial.print("  It is a constant: ");
+      Serial.println(word_at(word_ptr + 4), 16);
+      return;
+    }
+    if (routine == (uint32_t)&forth_do_var) {
+      Serial.print("  It is a variable at ");
+      Serial.println(word_ptr + 4, 16);
+      return;
+    }
+    if (routine == (uint32_t)&forth_do_value) {
+      Serial.print("  It is a value: ");
+      Serial.println(word_at(word_at(word_ptr + 4)), 16);
+      return;
+    }
+    if (routine != (uint32_t)&forth_do_colon) {
       Serial.println("  It is a native word.");
       return;
     }
+    // What INTERPRET would do with it, when compiling indirect threaded code.
+    uint32_t most = (len & 0x40) ? 0xffffffff : forth_var_INLINE_SIZE * 4;
+    uint32_t inline_length = forth_inline_length(word_ptr, most);
+    if (inline_length != 0xffffffff) {
+      Serial.print((len & 0x40) ? "  It is INLINE: " : "  It is short enough to inline: ");
+      Serial.print(inline_length / 4);
+      Serial.println(" cells.");
+    } else if ((len & 0x40) == 0x40) {
+      Serial.println("  It is INLINE, but can't be inlined.");
+    }
 
-    while (word_at(word_ptr) != (uint32_t)&forth_exit) {
+    // A definition ends at EXIT, or after the word a (TAIL) jumps to.
+    uint32_t end_ptr = 0;
+    while (word_ptr != end_ptr && word_at(word_ptr) != (uint32_t)&forth_exit) {
+      if (word_at(word_ptr) == (uint32_t)&forth_paren_tail) end_ptr = word_ptr + 8;
       uint32_t def_ptr = word_for(word_at(word_ptr));
       if (def_ptr != 0) {
         len = 31 & *(uint8_t *)(def_ptr + 8);
@@ -84,6 +137,158 @@ void dump_word(const char *word) {
   Serial.println(" not found.");
 }
 
+/*
+ * Prints how well the FIND index is doing: how many buckets are in use,
+ * how long the bucket chains are, and how many definitions FIND had to
+ * compare per lookup.
+ */
+void dump_find_index() {
+  uint32_t *buckets = &forth_find_index_buckets;
+  uint32_t used = 0;
+  uint32_t entries = 0;
+  uint32_t longest = 0;
+
+  for (uint32_t i = 0; i < forth_find_index_size; i++) {
+    uint32_t len = 0;
+    for (uint32_t node = buckets[i]; node != 0; node = word_at(node)) len++;
+    if (len != 0) used++;
+    if (len > longest) longest = len;
+    entries += len;
+  }
+
+  Serial.print("FIND INDEX: ");
+  Serial.print(entries);
+  Serial.print(" entries in ");
+  Serial.print(used);
+  Serial.print("/");
+  Serial.print(forth_find_index_size);
+  Serial.print(" buckets, longest chain ");
+  Serial.println(longest);
+  if (forth_find_index_overflow) {
+    Serial.println("  (out of nodes, FIND is walking the dictionary)");
+  }
+  Serial.print("  lookups: ");
+  Serial.print(forth_find_index_lookups);
+  Serial.print(" probes: ");
+  Serial.print(forth_find_index_probes);
+  if (forth_find_index_lookups != 0) {
+    uint32_t hundredths = forth_find_index_probes * 100 / forth_find_index_lookups;
+    Serial.print(" (");
+    Serial.print(hundredths / 100);
+    Serial.print(hundredths % 100 < 10 ? ".0" : ".");
+    Serial.print(hundredths % 100);
+    Serial.print(" per lookup)");
+  }
+  Serial.print(" rebuilds: ");
+  Serial.println(forth_find_index_rebuilds);
+}
+
+void print_word_name(uint32_t word) {
+  uint32_t def_ptr = word_for(word);
+  if (def_ptr == 0) {
+    Serial.print(word, 16);
+    return;
+  }
+  uint8_t len = 31 & *(uint8_t *)(def_ptr + 8);
+  for (uint8_t i = 0; i < len; i++) Serial.print(*(char *)(def_ptr + 9 + i));
+}
+
+/*
+ * Prints how many times each peephole rule fused a pair of words into
+ * one while compiling, and how many times each word was folded into
+ * the literals before it.
+ */
+void dump_peephole() {
+  uint32_t *rule = &forth_peephole_rules;
+
+  Serial.print("PEEPHOLE: ");
+  Serial.print(forth_peephole_fusions);
+  Serial.println(" fusions");
+  for (uint32_t i = 0; i < forth_peephole_size; i++, rule += 4) {
+    Serial.print("  ");
+    print_word_name(rule[0]);
+    Serial.print(' ');
+    print_word_name(rule[1]);
+    Serial.print(" -> ");
+    print_word_name(rule[2]);
+    Serial.print(": ");
+    Serial.println(rule[3]);
+  }
+
+  rule = &forth_fold_rules;
+  Serial.print("  ");
+  Serial.print(forth_peephole_folds);
+  Serial.println(" folds");
+  for (uint32_t i = 0; i < forth_peephole_fold_size; i++, rule += 4) {
+    Serial.print("  ");
+    print_word_name(rule[0]);
+    Serial.print(": ");
+    Serial.println(rule[3]);
+  }
+}
+
+/*
+ * Installs the dictionary that the bootstrap compiles, from
+ * bootstrap_image.S, rather than interpreting the bootstrap. Regenerate the
+ * image with make -C host image after changing the bootstrap.
+ */
+void install_bootstrap_image() {
+  uint32_t size = (uint32_t)&forth_bootstrap_image_end - (uint32_t)&forth_bootstrap_image;
+  memcpy(&_sheap, &forth_bootstrap_image, size);
+  forth_var_HERE = forth_bootstrap_image_here;
+  forth_var_LATEST = forth_bootstrap_image_latest;
+}
+
+/*
+ * Interprets the bootstrap. The image's code fields are indirect threaded,
+ * so FORTH_DIRECT_THREADED builds do this instead of installing it.
+ */
+void interpret_bootstrap() {
+  forth_var_STDIN = (uint32_t)bootstrap;
+  forth_var_STDIN_COUNT = strlen(bootstrap);
+  while (forth_var_STDIN_COUNT != 0) interpret();
+  forth_flush_output();
+}
+
+/*
+ * Interprets the bootstrap, and checks that it compiled exactly what's in
+ * the bootstrap image. Run it on a fresh system, in place of
+ * install_bootstrap_image().
+ */
+bool check_bootstrap_image() {
+  interpret_bootstrap();
+
+  bool ok = forth_var_HERE == forth_bootstrap_image_here &&
+      forth_var_LATEST == forth_bootstrap_image_latest;
+  Serial.println();
+  if (!ok) {
+    Serial.print("BOOTSTRAP IMAGE HERE/LATEST: expected ");
+    Serial.print(forth_bootstrap_image_here, 16);
+    Serial.print('/');
+    Serial.print(forth_bootstrap_image_latest, 16);
+    Serial.print(", got ");
+    Serial.print(forth_var_HERE, 16);
+    Serial.print('/');
+    Serial.println(forth_var_LATEST, 16);
+  }
+  // Only up to HERE: the image pads the last cell out with zeros.
+  uint32_t size = forth_bootstrap_image_here - (uint32_t)&_sheap;
+  for (uint32_t offset = 0; ok && offset < size; offset++) {
+    uint8_t expected = ((uint8_t *)&forth_bootstrap_image)[offset];
+    uint8_t actual = ((uint8_t *)&_sheap)[offset];
+    if (expected == actual) continue;
+    Serial.print("BOOTSTRAP IMAGE at +");
+    Serial.print(offset, 16);
+    Serial.print(": expected ");
+    Serial.print(expected, 16);
+    Serial.print(", got ");
+    Serial.println(actual, 16);
+    ok = false;
+  }
+  Serial.println(ok ? "BOOTSTRAP IMAGE OK" : "BOOTSTRAP IMAGE STALE");
+  return ok;
+}
+
 extern "C" int main(void)
 {
   delay(2000); // delay for USB to get enumerated
@@ -99,7 +304,9 @@ extern "C" int main(void)
   Serial.println((uint32_t)&_sheap, 16);
   Serial.print("HEAP END       : ");
   Serial.println((uint32_t)&_eheap, 16);
-  Serial.print("RAM END        : ");
+  Serial.print("STACK START    : ");
+  Serial.println((uint32_t)&_sstack, 16);
+  Serial.print("STACK END      : ");
   Serial.println((uint32_t)&_estack, 16);
   Serial.print("AVAILABLE HEAP : ");
   Serial.print((uint32_t)&_eheap - (uint32_t)&_sheap, 16);
@@ -107,19 +314,28 @@ extern "C" int main(void)
   Serial.print(((uint32_t)&_eheap - (uint32_t)&_sheap)/1000);
   Serial.println(" kiB)");
   Serial.print("AVAILABLE STACK: ");
-  Serial.print((uint32_t)&_estack - (uint32_t)&_eheap, 16);
+  Serial.print((uint32_t)&_estack - (uint32_t)&_sstack, 16);
   Serial.print(" (");
-  Serial.print(((uint32_t)&_estack - (uint32_t)&_eheap)/1000);
+  Serial.print(((uint32_t)&_estack - (uint32_t)&_sstack)/1000);
   Serial.println(" kiB)");
   Serial.println();
 
   //run_unit_tests();
-  forth_var_STDIN = (uint32_t)bootstrap;
-  forth_var_STDIN_COUNT = strlen(bootstrap);
+  //run_benchmarks();
+  //report_token_sizes();
+  //check_bootstrap_image();
+#ifdef FORTH_DIRECT_THREADED
+  interpret_bootstrap();
+#else
+  install_bootstrap_image();
+#endif
+  forth_var_STDIN = 0;
   while (true) {
     interpret();
     //dump_stack();
     //dump_word("OK");
+    //dump_find_index();
+    //dump_peephole();
   }
 
   pinMode(0, OUTPUT);
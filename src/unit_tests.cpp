@@ -9,9 +9,14 @@
 #include "WProgram.h"
 #include <usb_serial.h>
 #include <kinetis.h>
+#ifdef FORTH_HOST
+#include <initializer_list>
+#endif
 
+extern uint32_t *const data_stack;
 extern uint32_t forth_name_base;
 extern uint32_t forth_name_latest;
+extern uint32_t forth_name_hide;
 extern char forth_word_buffer;
 
 static char *forth_word_buffer_ptr = &forth_word_buffer;
@@ -19,6 +24,8 @@ static uint32_t original_var_here;
 static uint32_t original_var_latest;
 static const char* original_var_stdin;
 static uint32_t original_var_stdin_count;
+static uint32_t original_var_tail_calls;
+static uint32_t original_var_inline_size;
 
 struct Stack {
   const uint32_t size; // in 4-byte words
@@ -53,9 +60,41 @@ struct Test {
 };
 
 
+#ifdef FORTH_HOST
+/*
+ * Newer g++ won't let a temporary array outlive its expression, so on the
+ * host, Data copies its cells into a pool that lasts as long as the tests.
+ */
+class Data {
+ public:
+  Data(std::initializer_list<uint32_t> cells) : data_(pool_ + pool_used_) {
+    for (uint32_t cell : cells) pool_[pool_used_++] = cell;
+  }
+  operator const uint32_t*() const { return data_; }
+
+ private:
+  static uint32_t pool_[16384];
+  static uint32_t pool_used_;
+  const uint32_t *data_;
+};
+
+uint32_t Data::pool_[16384];
+uint32_t Data::pool_used_ = 0;
+#else
 typedef uint32_t Data[];
+#endif
 static const Stack empty_stack { 0, Data { } };
 
+// A colon word to tail call.
+static uint32_t tail_callee[] { (uint32_t)&forth_do_colon, (uint32_t)&forth_inc, (uint32_t)&forth_exit };
+
+#ifdef FORTH_PROFILE
+// Colon words for the profiler to profile.
+static uint32_t profile_callee[] { (uint32_t)&forth_do_colon, (uint32_t)&forth_exit };
+static uint32_t profile_caller[] {
+    (uint32_t)&forth_do_colon, (uint32_t)profile_callee, (uint32_t)&forth_exit };
+#endif
+
 /*
  *  All tests must begin with forth_do_colon and end with forth_exit,
  *  just like all non-native forth words do.
@@ -144,6 +183,21 @@ static Test tests[] {
             { 1, Data { 0x1234abcd } }
         }
     },
+    {
+        "LIT+",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_lit_add,
+              0x1234abcd,
+              (uint32_t)&forth_exit
+            },
+            { 1, Data { 1 } }
+        },
+        {
+            { 1, Data { 0x1234abce } }
+        }
+    },
     {
         "DROP",
         {
@@ -186,6 +240,20 @@ static Test tests[] {
             { 2, Data { 2, 1 } }
         }
     },
+    {
+        "NIP",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_nip,
+              (uint32_t)&forth_exit
+            },
+            { 2, Data { 1, 2 } }
+        },
+        {
+            { 1, Data { 2 } }
+        }
+    },
     {
         "2SWAP",
         {
@@ -424,6 +492,118 @@ static Test tests[] {
             { 1, Data { 3 } }
         }
     },
+    {
+        "UM*",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_umul,
+              (uint32_t)&forth_exit
+            },
+            { 2, Data { 0x80000001, 6 } }
+        },
+        {
+            { 2, Data { 6, 3 } }
+        }
+    },
+    {
+        "M*",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_mmul,
+              (uint32_t)&forth_exit
+            },
+            { 2, Data { (uint32_t)-3, 0x40000000 } }
+        },
+        {
+            { 2, Data { 0x40000000, 0xffffffff } }
+        }
+    },
+    {
+        "UM/MOD",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_um_divmod,
+              (uint32_t)&forth_exit
+            },
+            { 3, Data { 5, 7, 9 } }
+        },
+        {
+            { 2, Data { 6, 0xc71c71c7 } }
+        }
+    },
+    {
+        "SM/REM",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_sm_divrem,
+              (uint32_t)&forth_exit
+            },
+            { 3, Data { (uint32_t)-7, 0xffffffff, 2 } }
+        },
+        {
+            { 2, Data { (uint32_t)-1, (uint32_t)-3 } }
+        }
+    },
+    {
+        "FM/MOD",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_fm_divmod,
+              (uint32_t)&forth_exit
+            },
+            { 3, Data { (uint32_t)-7, 0xffffffff, 2 } }
+        },
+        {
+            { 2, Data { 1, (uint32_t)-4 } }
+        }
+    },
+    {
+        "*/",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_star_slash,
+              (uint32_t)&forth_exit
+            },
+            { 3, Data { 100000, 300000, 70000 } }
+        },
+        {
+            { 1, Data { 428571 } }
+        }
+    },
+    {
+        "D+",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_dadd,
+              (uint32_t)&forth_exit
+            },
+            { 4, Data { 0xffffffff, 1, 1, 2 } }
+        },
+        {
+            { 2, Data { 0, 4 } }
+        }
+    },
+    {
+        "D<",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_dlt,
+              (uint32_t)&forth_exit
+            },
+            { 4, Data { 5, (uint32_t)-1, 0, 0 } }
+        },
+        {
+            { 1, Data { 0xffffffff } }
+        }
+    },
     {
         "= (+)",
         {
@@ -942,6 +1122,62 @@ static Test tests[] {
             { 1, Data { 0x0f0f0f0f } }
         }
     },
+    {
+        "LSHIFT",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_lshift,
+              (uint32_t)&forth_exit
+            },
+            { 2, Data { 0x0000f0f1, 4 } }
+        },
+        {
+            { 1, Data { 0x000f0f10 } }
+        }
+    },
+    {
+        "RSHIFT",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_rshift,
+              (uint32_t)&forth_exit
+            },
+            { 2, Data { 0xf0f0f0f0, 4 } }
+        },
+        {
+            { 1, Data { 0x0f0f0f0f } }
+        }
+    },
+    {
+        "RSHIFT (32)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_rshift,
+              (uint32_t)&forth_exit
+            },
+            { 2, Data { 0xf0f0f0f0, 32 } }
+        },
+        {
+            { 1, Data { 0 } }
+        }
+    },
+    {
+        "LSHIFT (256)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_lshift,
+              (uint32_t)&forth_exit
+            },
+            { 2, Data { 1, 256 } }
+        },
+        {
+            { 1, Data { 0 } }
+        }
+    },
     {
         "!",
         {
@@ -950,10 +1186,11 @@ static Test tests[] {
               (uint32_t)&forth_store,
               (uint32_t)&forth_exit
             },
-            { 3, Data { 0xdeadbeef, 0xfeedface, (uint32_t)data_stack } }
+            // The top of the stack is cached in a register, so don't store into it.
+            { 4, Data { 0xdeadbeef, 0, 0xfeedface, (uint32_t)data_stack } }
         },
         {
-            { 1, Data { 0xfeedface } }
+            { 2, Data { 0xfeedface, 0 } }
         }
     },
     {
@@ -964,10 +1201,10 @@ static Test tests[] {
               (uint32_t)&forth_store_char,
               (uint32_t)&forth_exit
             },
-            { 3, Data { 0xdeadbeef, 0xfeedface, (uint32_t)data_stack } }
+            { 4, Data { 0xdeadbeef, 0, 0xfeedface, (uint32_t)data_stack } }
         },
         {
-            { 1, Data { 0xdeadbece } }
+            { 2, Data { 0xdeadbece, 0 } }
         }
     },
     {
@@ -984,6 +1221,20 @@ static Test tests[] {
             { 2, Data { 0xdeadbeef, 0xdeadbeef } }
         }
     },
+    {
+        "@+",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_fetch_add,
+              (uint32_t)&forth_exit
+            },
+            { 3, Data { 0xdeadbeef, 1, (uint32_t)data_stack } }
+        },
+        {
+            { 2, Data { 0xdeadbeef, 0xdeadbef0 } }
+        }
+    },
     {
         "C@",
         {
@@ -1006,10 +1257,10 @@ static Test tests[] {
               (uint32_t)&forth_addstore,
               (uint32_t)&forth_exit
             },
-            { 3, Data { 1, 2, (uint32_t)data_stack } }
+            { 4, Data { 1, 0, 2, (uint32_t)data_stack } }
         },
         {
-            { 1, Data { 3 } }
+            { 2, Data { 3, 0 } }
         }
     },
     {
@@ -1020,10 +1271,10 @@ static Test tests[] {
               (uint32_t)&forth_substore,
               (uint32_t)&forth_exit
             },
-            { 3, Data { 2, 1, (uint32_t)data_stack } }
+            { 4, Data { 2, 0, 1, (uint32_t)data_stack } }
         },
         {
-            { 1, Data { 1 } }
+            { 2, Data { 1, 0 } }
         }
     },
     {
@@ -1034,10 +1285,10 @@ static Test tests[] {
               (uint32_t)&forth_memcpy,
               (uint32_t)&forth_exit
             },
-            { 9, Data { 1, 2, 3, 4, 5, 6, (uint32_t)data_stack, (uint32_t)(data_stack+3), 12 } }
+            { 10, Data { 1, 2, 3, 4, 5, 6, 0, (uint32_t)data_stack, (uint32_t)(data_stack+3), 12 } }
         },
         {
-            { 6, Data { 1, 2, 3, 1, 2, 3 } }
+            { 7, Data { 1, 2, 3, 1, 2, 3, 0 } }
         }
     },
     {
@@ -1124,6 +1375,20 @@ static Test tests[] {
             { 3, Data { 0x00006131, 1, 1 } }
         }
     },
+    {
+        "NUMBER (no digits)", // "-."
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_number,
+              (uint32_t)&forth_exit
+            },
+            { 3, Data { 0x00002e2d, (uint32_t)data_stack, 2 } }
+        },
+        {
+            { 3, Data { 0x00002e2d, 0, 2 } }
+        }
+    },
     {
         "FIND (+)", // "BASE"
         {
@@ -1152,6 +1417,48 @@ static Test tests[] {
             { 2, Data { 0x46534142, 0 } }
         }
     },
+    {
+        "FIND (shadow)", // create "BASE", find it
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_2dup,
+              (uint32_t)&forth_create,
+              (uint32_t)&forth_find,
+              (uint32_t)&forth_exit
+            },
+            { 3, Data { 0x45534142, (uint32_t)data_stack, 4 } }
+        },
+        {
+            { 2, Data { 0x45534142, forth_var_HERE } },
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            0, // state
+            forth_var_HERE // latest
+        }
+    },
+    {
+        "FIND (hidden)", // create "BASE", hide it, find the builtin
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_2dup,
+              (uint32_t)&forth_create,
+              (uint32_t)&forth_latest,
+              (uint32_t)&forth_toggle_hidden,
+              (uint32_t)&forth_find,
+              (uint32_t)&forth_exit
+            },
+            { 3, Data { 0x45534142, (uint32_t)data_stack, 4 } }
+        },
+        {
+            { 2, Data { 0x45534142, (uint32_t)&forth_name_base } },
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            0, // state
+            forth_var_HERE // latest
+        }
+    },
     {
         ">CFA",
         {
@@ -1285,6 +1592,28 @@ static Test tests[] {
             forth_var_HERE // latest
         }
     },
+    {
+        "HIDDEN (builtin)", // hide "BASE", find it, unhide it, find it
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_toggle_hidden,
+              (uint32_t)&forth_find,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_name_base,
+              (uint32_t)&forth_toggle_hidden,
+              (uint32_t)&forth_rot,
+              (uint32_t)&forth_rot,
+              (uint32_t)&forth_find,
+              (uint32_t)&forth_exit
+            },
+            { 6, Data { 0x45534142, (uint32_t)data_stack, 4,
+                        (uint32_t)data_stack, 4, (uint32_t)&forth_name_base } }
+        },
+        {
+            { 3, Data { 0x45534142, 0, (uint32_t)&forth_name_base } }
+        }
+    },
     {
         "BRANCH",
         {
@@ -1334,288 +1663,1810 @@ static Test tests[] {
         }
     },
     {
-        "CHAR",
+        "DUP0BRANCH (+)",
         {
             Data {
               (uint32_t)&forth_do_colon,
-              (uint32_t)&forth_char,
+              (uint32_t)&forth_dup_brancheq,
+              1,
+              (uint32_t)&forth_add, // this should be skipped
               (uint32_t)&forth_exit
             },
-            empty_stack,
-            { 5, "0123 " }
+            { 3, Data { 1, 2, 0 } }
         },
         {
-            { 1, Data { (uint32_t) '0' } },
-            0, // stdin_left
-            { 4, "0123" } // word_buff
+            { 3, Data { 1, 2, 0 } }
         }
     },
     {
-        "'\\n'",
+        "DUP0BRANCH (-)",
         {
             Data {
               (uint32_t)&forth_do_colon,
-              (uint32_t)&forth_char_newline,
+              (uint32_t)&forth_dup_brancheq,
+              1,
+              (uint32_t)&forth_add, // this should not be skipped
               (uint32_t)&forth_exit
             },
-            empty_stack
+            { 3, Data { 1, 2, 1 } }
         },
         {
-            { 1, Data { 10 } }
+            { 2, Data { 1, 3 } }
         }
     },
     {
-        "BL",
+        "DO LOOP",
         {
             Data {
               (uint32_t)&forth_do_colon,
-              (uint32_t)&forth_char_space,
+              (uint32_t)&forth_paren_do,
+              3,
+              (uint32_t)&forth_i,
+              (uint32_t)&forth_paren_loop,
+              (uint32_t)-3,
               (uint32_t)&forth_exit
             },
-            empty_stack
+            { 2, Data { 3, 0 } }
+        },
+        {
+            { 3, Data { 0, 1, 2 } }
+        }
+    },
+    {
+        "DO +LOOP", // counting down, through the limit
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_paren_do,
+              5,
+              (uint32_t)&forth_i,
+              (uint32_t)&forth_lit,
+              (uint32_t)-2,
+              (uint32_t)&forth_paren_plus_loop,
+              (uint32_t)-5,
+              (uint32_t)&forth_exit
+            },
+            { 2, Data { 0, 4 } }
+        },
+        {
+            { 3, Data { 4, 2, 0 } }
+        }
+    },
+    {
+        "DO J",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_paren_do,
+              11,
+              (uint32_t)&forth_lit,
+              2,
+              (uint32_t)&forth_lit,
+              0,
+              (uint32_t)&forth_paren_do,
+              3,
+              (uint32_t)&forth_j,
+              (uint32_t)&forth_paren_loop,
+              (uint32_t)-3,
+              (uint32_t)&forth_paren_loop,
+              (uint32_t)-11,
+              (uint32_t)&forth_exit
+            },
+            { 2, Data { 12, 10 } }
+        },
+        {
+            { 4, Data { 10, 10, 11, 11 } }
+        }
+    },
+    {
+        "?DO (empty)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_paren_maybe_do,
+              3,
+              (uint32_t)&forth_i,
+              (uint32_t)&forth_paren_loop,
+              (uint32_t)-3,
+              (uint32_t)&forth_exit
+            },
+            { 3, Data { 7, 5, 5 } }
+        },
+        {
+            { 1, Data { 7 } }
+        }
+    },
+    {
+        "LEAVE",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_paren_do,
+              4,
+              (uint32_t)&forth_i,
+              (uint32_t)&forth_leave,
+              (uint32_t)&forth_paren_loop,
+              (uint32_t)-4,
+              (uint32_t)&forth_exit
+            },
+            { 2, Data { 3, 0 } }
+        },
+        {
+            { 1, Data { 0 } }
+        }
+    },
+    {
+        "UNLOOP",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_paren_do,
+              4,
+              (uint32_t)&forth_i,
+              (uint32_t)&forth_unloop,
+              (uint32_t)&forth_exit,
+              (uint32_t)&forth_paren_loop,
+              (uint32_t)-4
+            },
+            { 2, Data { 3, 0 } }
+        },
+        {
+            { 1, Data { 0 } }
+        }
+    },
+    {
+        "CHAR",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_char,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 5, "0123 " }
+        },
+        {
+            { 1, Data { (uint32_t) '0' } },
+            0, // stdin_left
+            { 4, "0123" } // word_buff
+        }
+    },
+    {
+        "'\\n'",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_char_newline,
+              (uint32_t)&forth_exit
+            },
+            empty_stack
+        },
+        {
+            { 1, Data { 10 } }
+        }
+    },
+    {
+        "BL",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_char_space,
+              (uint32_t)&forth_exit
+            },
+            empty_stack
         },
         {
             { 1, Data { ' ' } }
         }
     },
     {
-        "KEY",
+        "KEY",
+        {
+          Data {
+            (uint32_t)&forth_do_colon,
+            (uint32_t)&forth_key,
+            (uint32_t)&forth_exit
+          },
+          empty_stack,
+          { 2, "01" }
+        },
+        {
+          { 1, Data { '0' } },
+          1
+        }
+    },
+    {
+        "KEY (EOF)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_key,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 0, "" }
+        },
+        {
+            { 1, Data { 0xffffffff } },
+            0
+        }
+    },
+    {
+        "WORD",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_word,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 5, "0123 " }
+        },
+        {
+            { 2, Data { (uint32_t) &forth_word_buffer, 4 } },
+            0, // stdin_left
+            { 4, "0123" } // word_buff
+        }
+    },
+    {
+        "WORD (whitespace)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_word,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 9, " \t\r\n0123 " }
+        },
+        {
+            { 2, Data { (uint32_t) &forth_word_buffer, 4 } },
+            0, // stdin_left
+            { 4, "0123" } // word_buff
+        }
+    },
+    {
+        "WORD (backslash)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_word,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 10, " \\m \n0123 " }
+        },
+        {
+            { 2, Data { (uint32_t) &forth_word_buffer, 4 } },
+            0, // stdin_left
+            { 4, "0123" } // word_buff
+        }
+    },
+    {
+        "WORD (backslash at EOF)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_word,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 4, " \\m " }
+        },
+        {
+            { 2, Data { (uint32_t) &forth_word_buffer, 0 } },
+            0, // stdin_left
+        }
+    },
+    {
+        "PARSE-NAME",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_parse_name,
+              (uint32_t)&forth_swap,
+              (uint32_t)&forth_stdin,
+              (uint32_t)&forth_swap,
+              (uint32_t)&forth_sub, // how far the name is from the rest of the source
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 9, "  abc def" }
+        },
+        {
+            { 2, Data { 3, 4 } },
+            3, // stdin_left
+        }
+    },
+    {
+        "PARSE-NAME (long)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_parse_name,
+              (uint32_t)&forth_nip,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 41, "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx " }
+        },
+        {
+            { 1, Data { 40 } },
+            0, // stdin_left
+        }
+    },
+    {
+        "SOURCE",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_source,
+              (uint32_t)&forth_nip,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 3, "abc" }
+        },
+        {
+            { 1, Data { 3 } },
+            3, // stdin_left
+        }
+    },
+    {
+        ">IN",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_lit,
+              2,
+              (uint32_t)&forth_to_in,
+              (uint32_t)&forth_store,
+              (uint32_t)&forth_key,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 4, "abcd" }
+        },
+        {
+            { 1, Data { 'c' } },
+            1, // stdin_left
+        }
+    },
+    {
+        "REFILL (memory)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_refill,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 3, "abc" }
+        },
+        {
+            { 1, Data { 0 } },
+            3, // stdin_left
+        }
+    },
+    {
+        "ACCEPT",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_word_buffer,
+              (uint32_t)&forth_lit,
+              5,
+              (uint32_t)&forth_accept,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_word_buffer + 1,
+              (uint32_t)&forth_fetch_char,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 5, "ab\ncd" }
+        },
+        {
+            { 2, Data { 2, 'b' } },
+            2, // stdin_left
+        }
+    },
+    {
+        "INTERPRET (number)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 3, "123" }
+        },
+        {
+            { 1, Data { 123 } },
+        }
+    },
+    {
+        "INTERPRET (long number)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 34, "0000000000000000000000000000000042" }
+        },
+        {
+            { 1, Data { 42 } },
+        }
+    },
+    {
+        "INTERPRET (double)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 13, "-123456789.01" }
+        },
+        {
+            { 2, Data { 0x2023e3cb, 0xfffffffd } },
+        }
+    },
+    {
+        "INTERPRET (native word)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            { 2, Data { 1, 2 } },
+            { 1, "+" }
+        },
+        {
+            { 1, Data { 3 } },
+        }
+    },
+    {
+        "INTERPRET (forth word)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 3, "' +" }
+        },
+        {
+            { 1, Data { (uint32_t) &forth_add } },
+        }
+    },
+    {
+        "INTERPRET (comp num)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 3, "123" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            1 // state
+        }
+    },
+    {
+        "INTERPRET (comp word)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 1, "+" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            1 // state
+        }
+    },
+    {
+        "INTERPRET (fuse lit +)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 3, "5 +" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            1 // state
+        }
+    },
+    {
+        "INTERPRET (fuse lit -)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 3, "5 -" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            1 // state
+        }
+    },
+    {
+        "INTERPRET (fuse words)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 9, "SWAP DROP" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            1 // state
+        }
+    },
+    {
+        "INTERPRET (fold)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 12, "1 4 LSHIFT 3" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            1 // state
+        }
+    },
+    {
+        "INTERPRET (fold all)", // then INVERT and + fold too
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 21, "1 4 LSHIFT 3 INVERT +" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            1 // state
+        }
+    },
+    {
+        "INTERPRET (fold boundary)", // [ ] might be a branch target
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 9, "2 [ ] 3 *" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            1 // state
+        }
+    },
+    {
+        "INTERPRET (fold after word)", // 1+ doesn't take DUP as a literal
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 8, "2 DUP 1+" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            1 // state
+        }
+    },
+    {
+        "INTERPRET (DO LOOP)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 9, "DO I LOOP" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            1 // state
+        }
+    },
+    {
+        ":",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_compile_def,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 3, "123" },
+            { }
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            1, // state = compile_mode
+            forth_var_HERE // latest
+        }
+    },
+    {
+        ";",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_compile_def,
+              (uint32_t)&forth_end_compile_def,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 3, "123" },
+            { }
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            0, // state
+            forth_var_HERE // latest
+        }
+    },
+    {
+        "(TAIL)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_paren_tail,
+              (uint32_t)tail_callee,
+              (uint32_t)&forth_dec, // this should be skipped
+              (uint32_t)&forth_exit
+            },
+            { 1, Data { 1 } }
+        },
+        {
+            { 1, Data { 2 } }
+        }
+    },
+    {
+        "TAIL-CALL,",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_tail_calls_on,
+              (uint32_t)&forth_tail_call_comma,
+              (uint32_t)&forth_exit
+            },
+            { 1, Data { (uint32_t)&forth_hide } }
+        },
+        {
+            empty_stack
+        }
+    },
+    {
+        "EPILOGUE, (tail call)", // compile HIDE, run [, end the definition
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_lit,
+              0,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_var_INLINE_SIZE,
+              (uint32_t)&forth_store, // compile a call to HIDE
+              (uint32_t)&forth_tail_calls_on,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_epilogue,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 6, "HIDE [" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            0 // state
+        }
+    },
+    {
+        "EPILOGUE, (branch)", // compile HIDE, run [ and ], end the definition
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_lit,
+              0,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_var_INLINE_SIZE,
+              (uint32_t)&forth_store, // compile a call to HIDE
+              (uint32_t)&forth_tail_calls_on,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_epilogue,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 8, "HIDE [ [" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            0 // state
+        }
+    },
+    {
+        "EPILOGUE, (off)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_lit,
+              0,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_var_INLINE_SIZE,
+              (uint32_t)&forth_store, // compile a call to HIDE
+              (uint32_t)&forth_tail_calls_off,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_epilogue,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 6, "HIDE [" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            0 // state
+        }
+    },
+    {
+        "INTERPRET (inline)", // HIDE is three cells long
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_lit,
+              3,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_var_INLINE_SIZE,
+              (uint32_t)&forth_store,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 4, "HIDE" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            1 // state
+        }
+    },
+    {
+        "INTERPRET (inline too long)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_lit,
+              2,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_var_INLINE_SIZE,
+              (uint32_t)&forth_store,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 4, "HIDE" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            1 // state
+        }
+    },
+    {
+        "INLINE", // mark HIDE INLINE, compile it, and unmark it
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_name_hide,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_var_LATEST,
+              (uint32_t)&forth_store,
+              (uint32_t)&forth_toggle_inline,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_toggle_inline,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 4, "HIDE" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            1 // state
+        }
+    },
+    {
+        "INTERPRET (inline R>)", // EXIT-CALLER returns from T, so isn't inlined
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret, // : EXIT-CALLER
+              (uint32_t)&forth_interpret, // R>
+              (uint32_t)&forth_interpret, // DROP
+              (uint32_t)&forth_interpret, // ;
+              (uint32_t)&forth_interpret, // : T
+              (uint32_t)&forth_interpret, // 1
+              (uint32_t)&forth_interpret, // EXIT-CALLER
+              (uint32_t)&forth_interpret, // 2
+              (uint32_t)&forth_interpret, // ;
+              (uint32_t)&forth_interpret, // : U
+              (uint32_t)&forth_interpret, // T
+              (uint32_t)&forth_interpret, // 3
+              (uint32_t)&forth_interpret, // ;
+              (uint32_t)&forth_interpret, // U
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 57, ": EXIT-CALLER R> DROP ; : T 1 EXIT-CALLER 2 ; : U T 3 ; U" }
+        },
+        {
+            { 2, Data { 1, 3 } },
+            0, // stdin_left
+            { 1, "U" }, // word_buff
+            0 // state
+        }
+    },
+    {
+        "INTERPRET (inline R!)", // ZAP writes its return address, so U calls it
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret, // : ZAP
+              (uint32_t)&forth_interpret, // R!
+              (uint32_t)&forth_interpret, // ;
+              (uint32_t)&forth_interpret, // : U
+              (uint32_t)&forth_interpret, // ZAP
+              (uint32_t)&forth_interpret, // 1
+              (uint32_t)&forth_interpret, // ;
+              (uint32_t)&forth_interpret, // ' ZAP
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_var_LATEST,
+              (uint32_t)&forth_fetch,
+              (uint32_t)&forth_to_code_field_addr,
+              (uint32_t)&forth_inc4,
+              (uint32_t)&forth_fetch, // the first cell of U's body
+              (uint32_t)&forth_eq,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 28, ": ZAP R! ; : U ZAP 1 ; ' ZAP" }
+        },
+        {
+            { 1, Data { 0xffffffff } },
+            0, // stdin_left
+            { 3, "ZAP" }, // word_buff
+            0 // state
+        }
+    },
+    {
+        "'",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_code_field_addr_of_next_word,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 1, "+" }
+        },
+        {
+            { 1, Data { (uint32_t) &forth_add } },
+        }
+    },
+    {
+        "CONSTANT",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            { 1, Data { 42 } },
+            { 12, "CONSTANT X X" }
+        },
+        {
+            { 1, Data { 42 } },
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            0, // state
+            forth_var_HERE // latest
+        }
+    },
+    {
+        "VARIABLE",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 12, "VARIABLE X X" }
+        },
+        {
+            { 1, Data { forth_var_HERE + 16 } },
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            0, // state
+            forth_var_HERE // latest
+        }
+    },
+    {
+        "VALUE", // then TO it
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            { 2, Data { 9, 5 } },
+            { 14, "VALUE X TO X X" }
+        },
+        {
+            { 1, Data { 9 } },
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            0, // state
+            forth_var_HERE // latest
+        }
+    },
+    {
+        "TO (builtin)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            { 1, Data { 1 } },
+            { 8, "TO STATE" }
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            1 // state
+        }
+    },
+    {
+        "TO (compile)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 7, "TO BASE" },
+            { },
+            1 // compile mode
+        },
+        {
+            empty_stack,
+            0, // stdin_left
+            { 0, "" }, // word_buff
+            1 // state
+        }
+    },
+    {
+        "DOES>", // : K CREATE , DOES> @ 1+ ; 7 K X X
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 33, ": K CREATE , DOES> @ 1+ ; 7 K X X" }
+        },
+        {
+            { 1, Data { 8 } },
+        }
+    },
+    {
+        "LITERAL",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_literal,
+              (uint32_t)&forth_exit
+            },
+            { 1, Data { (uint32_t) &forth_add } },
+        },
+        {
+            empty_stack
+        }
+    },
+#ifndef FORTH_HOST // the host build doesn't generate Thumb-2 code
+    {
+        "LITERAL (native)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_native_mode,
+              (uint32_t)&forth_literal,
+              (uint32_t)&forth_threaded_mode,
+              (uint32_t)&forth_exit
+            },
+            { 1, Data { 0x1234abcd } },
+        },
+        {
+            empty_stack
+        }
+    },
+#endif
+    {
+        "LITERAL (token)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_token_mode,
+              (uint32_t)&forth_literal,
+              (uint32_t)&forth_threaded_mode,
+              (uint32_t)&forth_exit
+            },
+            { 1, Data { (uint32_t)-2 } },
+        },
+        {
+            empty_stack
+        }
+    },
+    {
+        "LITERAL (token, long)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_token_mode,
+              (uint32_t)&forth_literal,
+              (uint32_t)&forth_threaded_mode,
+              (uint32_t)&forth_exit
+            },
+            { 1, Data { 0x1234abcd } },
+        },
+        {
+            empty_stack
+        }
+    },
+    {
+        "COMPILE,",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_compile_comma,
+              (uint32_t)&forth_exit
+            },
+            { 1, Data { (uint32_t) &forth_add } },
+        },
+        {
+            empty_stack
+        }
+    },
+#ifndef FORTH_HOST
+    {
+        "COMPILE, (native inline)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_native_mode,
+              (uint32_t)&forth_compile_comma,
+              (uint32_t)&forth_threaded_mode,
+              (uint32_t)&forth_exit
+            },
+            { 1, Data { (uint32_t) &forth_dup } },
+        },
+        {
+            empty_stack
+        }
+    },
+    {
+        "COMPILE, (native exit)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_native_mode,
+              (uint32_t)&forth_compile_comma,
+              (uint32_t)&forth_threaded_mode,
+              (uint32_t)&forth_exit
+            },
+            { 1, Data { (uint32_t) &forth_exit } },
+        },
+        {
+            empty_stack
+        }
+    },
+#endif
+    {
+        "NATIVE",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_native_mode,
+              (uint32_t)&forth_interpret, // : SQ
+              (uint32_t)&forth_interpret, // DUP
+              (uint32_t)&forth_interpret, // *
+              (uint32_t)&forth_interpret, // ;
+              (uint32_t)&forth_interpret, // 3
+              (uint32_t)&forth_interpret, // SQ
+              (uint32_t)&forth_threaded_mode,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 17, ": SQ DUP * ; 3 SQ" }
+        },
+        {
+            { 1, Data { 9 } },
+            0, // stdin_left
+            { 2, "SQ" }, // word_buff
+            0, // state
+            forth_var_HERE // latest
+        }
+    },
+    {
+        "TOKENS",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_token_mode,
+              (uint32_t)&forth_interpret, // : SQ
+              (uint32_t)&forth_interpret, // DUP
+              (uint32_t)&forth_interpret, // *
+              (uint32_t)&forth_interpret, // ;
+              (uint32_t)&forth_interpret, // 3
+              (uint32_t)&forth_interpret, // SQ
+              (uint32_t)&forth_threaded_mode,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 17, ": SQ DUP * ; 3 SQ" }
+        },
+        {
+            { 1, Data { 9 } },
+            0, // stdin_left
+            { 2, "SQ" }, // word_buff
+            0, // state
+            forth_var_HERE // latest
+        }
+    },
+    {
+        "TOKENS (loop)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_token_mode,
+              (uint32_t)&forth_interpret, // : S
+              (uint32_t)&forth_interpret, // 0
+              (uint32_t)&forth_interpret, // 4
+              (uint32_t)&forth_interpret, // 0
+              (uint32_t)&forth_interpret, // DO
+              (uint32_t)&forth_interpret, // I
+              (uint32_t)&forth_interpret, // +
+              (uint32_t)&forth_interpret, // LOOP
+              (uint32_t)&forth_interpret, // ;
+              (uint32_t)&forth_interpret, // S
+              (uint32_t)&forth_threaded_mode,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 25, ": S 0 4 0 DO I + LOOP ; S" }
+        },
+        {
+            { 1, Data { 6 } },
+            0, // stdin_left
+            { 1, "S" }, // word_buff
+            0, // state
+            forth_var_HERE // latest
+        }
+    },
+    {
+        "TYPE",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_flush_when_full,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_word_buffer,
+              (uint32_t)&forth_lit,
+              3,
+              (uint32_t)&forth_type,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_output_tail,
+              (uint32_t)&forth_fetch,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_output_head,
+              (uint32_t)&forth_fetch,
+              (uint32_t)&forth_sub, // bytes buffered
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_output_tail,
+              (uint32_t)&forth_fetch,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_output_head,
+              (uint32_t)&forth_store, // discard the output
+              (uint32_t)&forth_flush_on_newline,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+        },
+        {
+            { 1, Data { 3 } }
+        }
+    },
+    {
+        "CR (FLUSH-WHEN-FULL)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_flush_when_full,
+              (uint32_t)&forth_cr,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_output_tail,
+              (uint32_t)&forth_fetch,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_output_head,
+              (uint32_t)&forth_fetch,
+              (uint32_t)&forth_sub, // bytes buffered
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_output_tail,
+              (uint32_t)&forth_fetch,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_output_head,
+              (uint32_t)&forth_store, // discard the output
+              (uint32_t)&forth_flush_on_newline,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+        },
+        {
+            { 1, Data { 1 } }
+        }
+    },
+    {
+        "CR (FLUSH-ON-NEWLINE)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_flush_on_newline,
+              (uint32_t)&forth_cr,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_output_tail,
+              (uint32_t)&forth_fetch,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_output_head,
+              (uint32_t)&forth_fetch,
+              (uint32_t)&forth_sub, // bytes buffered
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+        },
+        {
+            { 1, Data { 0 } }
+        }
+    },
+    {
+        "PAUSE (alone)",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_lit,
+              1,
+              (uint32_t)&forth_pause, // no other task, so this goes on
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+        },
+        {
+            { 1, Data { 1 } }
+        }
+    },
+    {
+        "TASK",
+        {
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret, // VARIABLE V
+              (uint32_t)&forth_interpret, // : T
+              (uint32_t)&forth_interpret, // 1 V +! PAUSE 2 V +! ;
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // 8 8 TASK A
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // ' T
+              (uint32_t)&forth_interpret, // A START
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // PAUSE, to A
+              (uint32_t)&forth_interpret, // V @
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // PAUSE, to A, which stops
+              (uint32_t)&forth_interpret, // V @
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 79, "VARIABLE V : T 1 V +! PAUSE 2 V +! ; 8 8 TASK A ' T A START PAUSE V @ PAUSE V @" }
+        },
+        {
+            { 2, Data { 1, 3 } }
+        }
+    },
+    {
+        "STOP",
         {
-          Data {
-            (uint32_t)&forth_do_colon,
-            (uint32_t)&forth_key,
-            (uint32_t)&forth_exit
-          },
-          empty_stack,
-          { 2, "01" }
+            Data {
+              (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret, // VARIABLE V
+              (uint32_t)&forth_interpret, // : T
+              (uint32_t)&forth_interpret, // 1 V +! PAUSE 2 V +! ;
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // 8 8 TASK A
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // ' T
+              (uint32_t)&forth_interpret, // A START
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // PAUSE, to A
+              (uint32_t)&forth_interpret, // A STOP
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // PAUSE, but A is asleep
+              (uint32_t)&forth_interpret, // V @
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_exit
+            },
+            empty_stack,
+            { 82, "VARIABLE V : T 1 V +! PAUSE 2 V +! ; 8 8 TASK A ' T A START PAUSE A STOP PAUSE V @" }
         },
         {
-          { 1, Data { '0' } },
-          1
+            { 1, Data { 1 } }
         }
     },
     {
-        "KEY (EOF)",
+        "STOP (main asleep)", // A stops when T returns, which wakes main
         {
             Data {
               (uint32_t)&forth_do_colon,
-              (uint32_t)&forth_key,
+              (uint32_t)&forth_interpret, // VARIABLE V
+              (uint32_t)&forth_interpret, // : T
+              (uint32_t)&forth_interpret, // 7 V ! ;
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // 8 8 TASK A
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // ' T
+              (uint32_t)&forth_interpret, // A START
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_task_main,
+              (uint32_t)&forth_stop, // to A
+              (uint32_t)&forth_interpret, // V @
+              (uint32_t)&forth_interpret,
               (uint32_t)&forth_exit
             },
             empty_stack,
-            { 0, "" }
+            { 49, "VARIABLE V : T 7 V ! ; 8 8 TASK A ' T A START V @" }
         },
         {
-            { 1, Data { 0xffffffff } },
-            0
+            { 1, Data { 7 } }
         }
     },
     {
-        "WORD",
+        "TASK (BASE)",
         {
             Data {
               (uint32_t)&forth_do_colon,
-              (uint32_t)&forth_word,
+              (uint32_t)&forth_interpret, // : T
+              (uint32_t)&forth_interpret, // 16 TO BASE PAUSE ;
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // 8 8 TASK A
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // ' T
+              (uint32_t)&forth_interpret, // A START
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // PAUSE, to A
+              (uint32_t)&forth_interpret, // BASE
               (uint32_t)&forth_exit
             },
             empty_stack,
-            { 5, "0123 " }
+            { 56, ": T 16 TO BASE PAUSE ; 8 8 TASK A ' T A START PAUSE BASE" }
         },
         {
-            { 2, Data { (uint32_t) &forth_word_buffer, 4 } },
-            0, // stdin_left
-            { 4, "0123" } // word_buff
+            { 1, Data { 10 } }
         }
     },
     {
-        "WORD (whitespace)",
+        "TASK (floats)", // each task pops its own float
         {
             Data {
               (uint32_t)&forth_do_colon,
-              (uint32_t)&forth_word,
+              (uint32_t)&forth_interpret, // VARIABLE R
+              (uint32_t)&forth_interpret, // : T
+              (uint32_t)&forth_interpret, // 2E0 PAUSE F>S R ! ;
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // 8 8 TASK A
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // ' T
+              (uint32_t)&forth_interpret, // A START
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // 1E0 PAUSE, to A
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // F>S
+              (uint32_t)&forth_interpret, // PAUSE, to A, which stops
+              (uint32_t)&forth_interpret, // R @
+              (uint32_t)&forth_interpret,
               (uint32_t)&forth_exit
             },
             empty_stack,
-            { 9, " \t\r\n0123 " }
+            { 81, "VARIABLE R : T 2E0 PAUSE F>S R ! ; 8 8 TASK A ' T A START 1E0 PAUSE F>S PAUSE R @" }
         },
         {
-            { 2, Data { (uint32_t) &forth_word_buffer, 4 } },
-            0, // stdin_left
-            { 4, "0123" } // word_buff
+            { 2, Data { 1, 2 } }
         }
     },
     {
-        "WORD (backslash)",
+        "BIND-IRQ",
         {
             Data {
               (uint32_t)&forth_do_colon,
-              (uint32_t)&forth_word,
+              (uint32_t)&forth_interpret, // VARIABLE V
+              (uint32_t)&forth_interpret, // : T
+              (uint32_t)&forth_interpret, // 1 V +! 7 ;
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // ' T
+              (uint32_t)&forth_interpret, // 5 BIND-IRQ
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // 5 TRIGGER-IRQ, runs T
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // 5 TRIGGER-IRQ
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // V @, and the 7s were on the interrupt stack
+              (uint32_t)&forth_interpret,
               (uint32_t)&forth_exit
             },
             empty_stack,
-            { 10, " \\m \n0123 " }
+            { 72, "VARIABLE V : T 1 V +! 7 ; ' T 5 BIND-IRQ 5 TRIGGER-IRQ 5 TRIGGER-IRQ V @" }
         },
         {
-            { 2, Data { (uint32_t) &forth_word_buffer, 4 } },
-            0, // stdin_left
-            { 4, "0123" } // word_buff
+            { 1, Data { 2 } }
         }
     },
     {
-        "INTERPRET (number)",
+        "IRQ_LATENCY",
         {
             Data {
               (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret, // 0 TO IRQ_LATENCY
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // : T ;
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // ' T
+              (uint32_t)&forth_interpret, // 5 BIND-IRQ
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // 5 TRIGGER-IRQ
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // IRQ_LATENCY 0<>
               (uint32_t)&forth_interpret,
               (uint32_t)&forth_exit
             },
             empty_stack,
-            { 3, "123" }
+            { 67, "0 TO IRQ_LATENCY : T ; ' T 5 BIND-IRQ 5 TRIGGER-IRQ IRQ_LATENCY 0<>" }
         },
         {
-            { 1, Data { 123 } },
+            { 1, Data { 0xffffffff } }
         }
     },
     {
-        "INTERPRET (native word)",
+        "F+",
         {
             Data {
               (uint32_t)&forth_do_colon,
-              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // 1.5E0
+              (uint32_t)&forth_interpret, // 2.5E0
+              (uint32_t)&forth_interpret, // F+
+              (uint32_t)&forth_interpret, // F>S
               (uint32_t)&forth_exit
             },
-            { 2, Data { 1, 2 } },
-            { 1, "+" }
+            empty_stack,
+            { 18, "1.5E0 2.5E0 F+ F>S" }
         },
         {
-            { 1, Data { 3 } },
+            { 1, Data { 4 } }
         }
     },
     {
-        "INTERPRET (forth word)",
+        "FLITERAL",
         {
             Data {
               (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret, // : T
+              (uint32_t)&forth_interpret, // 1.25E0 F* ;, compiling LIT <bits> (FLITERAL)
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // 8E0 T F>S
+              (uint32_t)&forth_interpret,
               (uint32_t)&forth_interpret,
               (uint32_t)&forth_exit
             },
             empty_stack,
-            { 3, "' +" }
+            { 25, ": T 1.25E0 F* ; 8E0 T F>S" }
         },
         {
-            { 1, Data { (uint32_t) &forth_add } },
+            { 1, Data { 10 } }
         }
     },
     {
-        "INTERPRET (comp num)",
+        "F<",
         {
             Data {
               (uint32_t)&forth_do_colon,
+              (uint32_t)&forth_interpret, // 7 S>F
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // 2E0 F/
+              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_interpret, // 4E0 F<
               (uint32_t)&forth_interpret,
               (uint32_t)&forth_exit
             },
             empty_stack,
-            { 3, "123" },
-            { },
-            1 // compile mode
+            { 19, "7 S>F 2E0 F/ 4E0 F<" }
         },
         {
-            empty_stack,
-            0, // stdin_left
-            { 0, "" }, // word_buff
-            1 // state
+            { 1, Data { 0xffffffff } }
         }
     },
     {
-        "INTERPRET (comp word)",
+        "VH+",
         {
             Data {
               (uint32_t)&forth_do_colon,
-              (uint32_t)&forth_interpret,
+              (uint32_t)&forth_vhadd,
               (uint32_t)&forth_exit
             },
-            empty_stack,
-            { 1, "+" },
-            { },
-            1 // compile mode
+            // 1 -2 3 7fff 5 + 10 20 30 1 -5, into the first array
+            { 10, Data { 0xfffe0001, 0x7fff0003, 5, 0x0014000a, 0x0001001e, 0xfffb,
+                         (uint32_t)data_stack, (uint32_t)(data_stack+3), (uint32_t)data_stack, 5 } }
         },
         {
-            empty_stack,
-            0, // stdin_left
-            { 0, "" }, // word_buff
-            1 // state
+            { 6, Data { 0x0012000b, 0x80000021, 0, 0x0014000a, 0x0001001e, 0xfffb } }
         }
     },
     {
-        ":",
+        "VHDOT",
         {
             Data {
               (uint32_t)&forth_do_colon,
-              (uint32_t)&forth_compile_def,
+              (uint32_t)&forth_vhdot,
               (uint32_t)&forth_exit
             },
-            empty_stack,
-            { 3, "123" },
-            { }
+            { 9, Data { 0xfffe0001, 0x7fff0003, 5, 0x0014000a, 0x0001001e, 0xfffb,
+                        (uint32_t)data_stack, (uint32_t)(data_stack+3), 5 } }
         },
         {
-            empty_stack,
-            0, // stdin_left
-            { 0, "" }, // word_buff
-            1, // state = compile_mode
-            forth_var_HERE // latest
+            { 7, Data { 0xfffe0001, 0x7fff0003, 5, 0x0014000a, 0x0001001e, 0xfffb, 32802 } }
         }
     },
     {
-        ";",
+        "VHMAX",
         {
             Data {
               (uint32_t)&forth_do_colon,
-              (uint32_t)&forth_compile_def,
-              (uint32_t)&forth_end_compile_def,
+              (uint32_t)&forth_vhmax,
               (uint32_t)&forth_exit
             },
-            empty_stack,
-            { 3, "123" },
-            { }
+            { 5, Data { 0xfffe0001, 0x7fff0003, 0xfffb, (uint32_t)data_stack, 5 } }
         },
         {
-            empty_stack,
-            0, // stdin_left
-            { 0, "" }, // word_buff
-            0, // state
-            forth_var_HERE // latest
+            { 4, Data { 0xfffe0001, 0x7fff0003, 0xfffb, 0x7fff } }
         }
     },
+#ifdef FORTH_PROFILE
     {
-        "'",
+        "PROFILE-RESET (calls)",
         {
             Data {
               (uint32_t)&forth_do_colon,
-              (uint32_t)&forth_code_field_addr_of_next_word,
+              (uint32_t)&forth_profile_reset,
+              (uint32_t)profile_callee,
+              (uint32_t)profile_callee,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_profile_records, // first record's word
+              (uint32_t)&forth_fetch,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_profile_records + 4, // and its calls
+              (uint32_t)&forth_fetch,
               (uint32_t)&forth_exit
             },
             empty_stack,
-            { 1, "+" }
         },
         {
-            { 1, Data { (uint32_t) &forth_add } },
+            { 2, Data { (uint32_t)profile_callee, 2 } }
         }
     },
     {
-        "LITERAL",
+        "PROFILE-RESET (cycles)",
         {
             Data {
               (uint32_t)&forth_do_colon,
-              (uint32_t)&forth_literal,
+              (uint32_t)&forth_profile_reset,
+              (uint32_t)profile_caller,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_profile_records + 8, // caller's inclusive cycles
+              (uint32_t)&forth_fetch,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_profile_records + 16, // caller's exclusive cycles
+              (uint32_t)&forth_fetch,
+              (uint32_t)&forth_sub,
+              (uint32_t)&forth_lit,
+              (uint32_t)&forth_profile_records + 24 + 8, // callee's inclusive cycles
+              (uint32_t)&forth_fetch,
+              (uint32_t)&forth_eq,
               (uint32_t)&forth_exit
             },
-            { 1, Data { (uint32_t) &forth_add } },
+            empty_stack,
         },
         {
-            empty_stack
+            { 1, Data { 0xffffffff } }
         }
     },
+#endif
 };
 
 static Buff *get_expected_user_mem(const char *test_name) {
@@ -1673,6 +3524,82 @@ static Buff *get_expected_user_mem(const char *test_name) {
     return &interpret_comp_word_user_mem;
   }
 
+  if (!strcmp(test_name, "INTERPRET (fuse lit +)")) {
+    static uint32_t interpret_fuse_lit_add_data[] = { (uint32_t) &forth_lit_add, 5 };
+    static Buff interpret_fuse_lit_add_user_mem = { 8, (char *)&interpret_fuse_lit_add_data };
+
+    return &interpret_fuse_lit_add_user_mem;
+  }
+
+  if (!strcmp(test_name, "INTERPRET (fuse lit -)")) {
+    static uint32_t interpret_fuse_lit_sub_data[] = { (uint32_t) &forth_lit_add, (uint32_t) -5 };
+    static Buff interpret_fuse_lit_sub_user_mem = { 8, (char *)&interpret_fuse_lit_sub_data };
+
+    return &interpret_fuse_lit_sub_user_mem;
+  }
+
+  if (!strcmp(test_name, "INTERPRET (fuse words)")) {
+    static uint32_t interpret_fuse_words_data[] = { (uint32_t) &forth_nip };
+    static Buff interpret_fuse_words_user_mem = { 4, (char *)&interpret_fuse_words_data };
+
+    return &interpret_fuse_words_user_mem;
+  }
+
+  if (!strcmp(test_name, "INTERPRET (fold)")) {
+    static uint32_t interpret_fold_data[] = { (uint32_t) &forth_lit, 16, (uint32_t) &forth_lit, 3 };
+    static Buff interpret_fold_user_mem = { 16, (char *)&interpret_fold_data };
+
+    return &interpret_fold_user_mem;
+  }
+
+  if (!strcmp(test_name, "INTERPRET (fold all)")) {
+    static uint32_t interpret_fold_all_data[] = { (uint32_t) &forth_lit, 12 };
+    static Buff interpret_fold_all_user_mem = { 8, (char *)&interpret_fold_all_data };
+
+    return &interpret_fold_all_user_mem;
+  }
+
+  if (!strcmp(test_name, "INTERPRET (fold boundary)")) {
+    static uint32_t interpret_fold_boundary_data[] = {
+      (uint32_t) &forth_lit, 2, (uint32_t) &forth_lit, 3, (uint32_t) &forth_mul
+    };
+    static Buff interpret_fold_boundary_user_mem = { 20, (char *)&interpret_fold_boundary_data };
+
+    return &interpret_fold_boundary_user_mem;
+  }
+
+  if (!strcmp(test_name, "INTERPRET (fold after word)")) {
+    static uint32_t interpret_fold_after_word_data[] = {
+      (uint32_t) &forth_lit, 2, (uint32_t) &forth_dup, (uint32_t) &forth_inc
+    };
+    static Buff interpret_fold_after_word_user_mem = { 16, (char *)&interpret_fold_after_word_data };
+
+    return &interpret_fold_after_word_user_mem;
+  }
+
+  if (!strcmp(test_name, "INTERPRET (DO LOOP)")) {
+    static uint32_t interpret_do_loop_data[] = {
+      (uint32_t) &forth_paren_do, 3, (uint32_t) &forth_i, (uint32_t) &forth_paren_loop, (uint32_t) -3
+    };
+    static Buff interpret_do_loop_user_mem = { 20, (char *)&interpret_do_loop_data };
+
+    return &interpret_do_loop_user_mem;
+  }
+
+  if (!strcmp(test_name, "TAIL-CALL,") || !strcmp(test_name, "EPILOGUE, (tail call)")) {
+    static uint32_t tail_call_data[] = { (uint32_t) &forth_paren_tail, (uint32_t) &forth_hide };
+    static Buff tail_call_user_mem = { 8, (char *)&tail_call_data };
+
+    return &tail_call_user_mem;
+  }
+
+  if (!strcmp(test_name, "EPILOGUE, (branch)") || !strcmp(test_name, "EPILOGUE, (off)")) {
+    static uint32_t no_tail_call_data[] = { (uint32_t) &forth_hide, (uint32_t) &forth_exit };
+    static Buff no_tail_call_user_mem = { 8, (char *)&no_tail_call_data };
+
+    return &no_tail_call_user_mem;
+  }
+
   if (!strcmp(test_name, ":")) {
     static char create_data[] { 0, 0, 0, 0, 0, 0, 0, 0, 0x23, '1', '2', '3', 0, 0, 0, 0 };
     static Buff create_user_mem = { 16, create_data };
@@ -1680,11 +3607,28 @@ static Buff *get_expected_user_mem(const char *test_name) {
     if (*(uint32_t *)create_user_mem.data == 0) {
       *(uint32_t *)create_user_mem.data = original_var_latest;
       *(uint32_t *)(create_user_mem.data + 4) = original_var_here + 12;
-      *(uint32_t *)(create_user_mem.data + 12) = (uint32_t)&forth_do_colon;
+      *(uint32_t *)(create_user_mem.data + 12) =
+          forth_code_field((uint32_t)&forth_do_colon, original_var_here + 12);
     }
     return &create_user_mem;
   }
 
+  if (!strcmp(test_name, "INTERPRET (inline)") || !strcmp(test_name, "INLINE")) {
+    static uint32_t inline_data[] = {
+      (uint32_t) &forth_parse_name, (uint32_t) &forth_find, (uint32_t) &forth_toggle_hidden
+    };
+    static Buff inline_user_mem = { 12, (char *)&inline_data };
+
+    return &inline_user_mem;
+  }
+
+  if (!strcmp(test_name, "INTERPRET (inline too long)")) {
+    static uint32_t inline_too_long_data[] = { (uint32_t) &forth_hide };
+    static Buff inline_too_long_user_mem = { 4, (char *)&inline_too_long_data };
+
+    return &inline_too_long_user_mem;
+  }
+
   if (!strcmp(test_name, ";")) {
     static char create_data[] { 0, 0, 0, 0, 0, 0, 0, 0, 3, '1', '2', '3', 0, 0, 0, 0, 0, 0, 0, 0 };
     static Buff create_user_mem = { 20, create_data };
@@ -1692,7 +3636,8 @@ static Buff *get_expected_user_mem(const char *test_name) {
     if (*(uint32_t *)create_user_mem.data == 0) {
       *(uint32_t *)create_user_mem.data = original_var_latest;
       *(uint32_t *)(create_user_mem.data + 4) = original_var_here + 12;
-      *(uint32_t *)(create_user_mem.data + 12) = (uint32_t)&forth_do_colon;
+      *(uint32_t *)(create_user_mem.data + 12) =
+          forth_code_field((uint32_t)&forth_do_colon, original_var_here + 12);
       *(uint32_t *)(create_user_mem.data + 16) = (uint32_t)&forth_exit;
     }
     return &create_user_mem;
@@ -1709,6 +3654,88 @@ static Buff *get_expected_user_mem(const char *test_name) {
     return &literal_user_mem;
   }
 
+  if (!strcmp(test_name, "CONSTANT")) {
+    static uint32_t constant_data[] = { 0, 0, 0x5801, 0, 42 }; // "X"
+    static Buff constant_user_mem = { 20, (char *)&constant_data };
+
+    constant_data[0] = original_var_latest;
+    constant_data[1] = original_var_here + 12;
+    constant_data[3] = forth_code_field((uint32_t)&forth_do_const, original_var_here + 12);
+    return &constant_user_mem;
+  }
+
+  if (!strcmp(test_name, "VARIABLE")) {
+    static uint32_t variable_data[] = { 0, 0, 0x5801, 0, 0 }; // "X"
+    static Buff variable_user_mem = { 20, (char *)&variable_data };
+
+    variable_data[0] = original_var_latest;
+    variable_data[1] = original_var_here + 12;
+    variable_data[3] = forth_code_field((uint32_t)&forth_do_var, original_var_here + 12);
+    return &variable_user_mem;
+  }
+
+  if (!strcmp(test_name, "VALUE")) {
+    static uint32_t value_data[] = { 0, 0, 0x5801, 0, 0, 9 }; // "X"
+    static Buff value_user_mem = { 24, (char *)&value_data };
+
+    value_data[0] = original_var_latest;
+    value_data[1] = original_var_here + 12;
+    value_data[3] = forth_code_field((uint32_t)&forth_do_value, original_var_here + 12);
+    value_data[4] = original_var_here + 20;
+    return &value_user_mem;
+  }
+
+  if (!strcmp(test_name, "TO (compile)")) {
+    static uint32_t to_data[] = { (uint32_t) &forth_lit, (uint32_t) &forth_var_BASE, (uint32_t) &forth_store };
+    static Buff to_user_mem = { 12, (char *)&to_data };
+
+    return &to_user_mem;
+  }
+
+  if (!strcmp(test_name, "LITERAL (native)")) {
+    // str r7, [r11], #4; movw r7, #0xabcd; movt r7, #0x1234
+    static uint16_t literal_native_data[] = { 0xf84b, 0x7b04, 0xf64a, 0x37cd, 0xf2c1, 0x2734 };
+    static Buff literal_native_user_mem = { 12, (char *)&literal_native_data };
+
+    return &literal_native_user_mem;
+  }
+
+  if (!strcmp(test_name, "LITERAL (token)")) {
+    static uint16_t literal_token_data[] = { 2, 0xfffe }; // LIT16 -2
+    static Buff literal_token_user_mem = { 4, (char *)&literal_token_data };
+
+    return &literal_token_user_mem;
+  }
+
+  if (!strcmp(test_name, "LITERAL (token, long)")) {
+    static uint16_t literal_token_long_data[] = { 1, 0xabcd, 0x1234 }; // LIT, low half first
+    static Buff literal_token_long_user_mem = { 6, (char *)&literal_token_long_data };
+
+    return &literal_token_long_user_mem;
+  }
+
+  if (!strcmp(test_name, "COMPILE,")) {
+    static uint32_t compile_comma_data[] = { (uint32_t) &forth_add };
+    static Buff compile_comma_user_mem = { 4, (char *)&compile_comma_data };
+
+    return &compile_comma_user_mem;
+  }
+
+  if (!strcmp(test_name, "COMPILE, (native inline)")) {
+    // DUP's native code: str r7, [r11], #4
+    static uint16_t compile_comma_inline_data[] = { 0xf84b, 0x7b04 };
+    static Buff compile_comma_inline_user_mem = { 4, (char *)&compile_comma_inline_data };
+
+    return &compile_comma_inline_user_mem;
+  }
+
+  if (!strcmp(test_name, "COMPILE, (native exit)")) {
+    static uint16_t compile_comma_exit_data[] = { 0xbd00 }; // pop {pc}
+    static Buff compile_comma_exit_user_mem = { 2, (char *)&compile_comma_exit_data };
+
+    return &compile_comma_exit_user_mem;
+  }
+
   return nullptr;
 }
 
@@ -1733,6 +3760,16 @@ void run_unit_tests() {
   original_var_latest = forth_var_LATEST;
   original_var_stdin = (const char *) forth_var_STDIN;
   original_var_stdin_count = forth_var_STDIN_COUNT;
+  original_var_tail_calls = forth_var_TAIL_CALLS;
+  original_var_inline_size = forth_var_INLINE_SIZE;
+
+  // With FORTH_DIRECT_THREADED, the colon words above need code fields
+  // that are code.
+  tail_callee[0] = forth_code_field((uint32_t)&forth_do_colon, (uint32_t)tail_callee);
+#ifdef FORTH_PROFILE
+  profile_callee[0] = forth_code_field((uint32_t)&forth_do_colon, (uint32_t)profile_callee);
+  profile_caller[0] = forth_code_field((uint32_t)&forth_do_colon, (uint32_t)profile_caller);
+#endif
 
   for (int i = 0; i < sizeof(tests)/sizeof(Test); i++) {
     Serial.print(tests[i].name);
@@ -1751,6 +3788,12 @@ void run_unit_tests() {
     forth_var_STATE = tests[i].setup.state;
     forth_var_STDIN = (uint32_t) tests[i].setup.stdin_.data;
     forth_var_STDIN_COUNT = tests[i].setup.stdin_.size;
+    forth_var_TAIL_CALLS = original_var_tail_calls;
+    forth_var_INLINE_SIZE = original_var_inline_size;
+    forth_peephole_here = 0;
+    forth_task_main = (uint32_t)&forth_task_main; // forget the tasks
+    (&forth_task_main)[1] = 1; // and wake the main task
+    forth_fsp = (uint32_t)&forth_float_stack; // and the floats
 
     __disable_irq();
     uint32_t count_start = ARM_DWT_CYCCNT;
@@ -1759,6 +3802,7 @@ void run_unit_tests() {
 
     uint32_t count_end = ARM_DWT_CYCCNT;
     __enable_irq();
+    forth_flush_output();
 
     // For the QUIT test, we are using less cycles than "normal", so
     // we need a negative number here.
@@ -1884,4 +3928,6 @@ void run_unit_tests() {
 
     if (i == 0) base_cycle_count = cycle_count;
   }
+
+  forth_var_INLINE_SIZE = original_var_inline_size;
 }